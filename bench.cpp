@@ -0,0 +1,252 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+// heap tracking needs the allocator's block size (glibc, macOS), the process peak getrusage (POSIX)
+// other platforms print "-" in those columns
+#if defined(__GLIBC__) || defined(__APPLE__)
+#define BENCH_HEAP_TRACKING 1
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#define BENCH_PROCESS_RSS 1
+#include <sys/resource.h>
+#endif
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include "third_party/Numerical.h"
+#include "third_party/Profiler.h"
+#include "third_party/SimConfig.h"
+#include "third_party/ThreadPool.h"
+
+// solver benchmark: sweeps grid size, species count, boundary condition and diffusion method
+// and reports the time per cell and step, heap allocations and memory use of every case
+
+using namespace std;
+
+// every heap allocation of the process goes through these, counted while a case is timed
+static atomic<uint64_t> allocations{0};
+static atomic<uint64_t> allocated_bytes{0};
+// heap in use and its high-water mark since the start of the timed run, per case unlike ru_maxrss
+static atomic<int64_t> live_bytes{0};
+static atomic<int64_t> peak_live_bytes{0};
+
+#ifdef BENCH_HEAP_TRACKING
+
+static constexpr bool heap_tracking = true;
+
+static size_t block_size(void* p) {
+#ifdef __APPLE__
+    return malloc_size(p);
+#else
+    return malloc_usable_size(p);
+#endif
+}
+
+static void* counted_alloc(size_t size, size_t alignment) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    allocated_bytes.fetch_add(size, memory_order_relaxed);
+    void* p = nullptr;
+    if (alignment <= alignof(max_align_t)) p = malloc(size ? size : 1);
+    else if (posix_memalign(&p, alignment, size ? size : 1) != 0) p = nullptr;
+    if (!p) throw bad_alloc();
+    const int64_t live = live_bytes.fetch_add(block_size(p), memory_order_relaxed) + block_size(p);
+    int64_t peak = peak_live_bytes.load(memory_order_relaxed);
+    while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {}
+    return p;
+}
+
+static void counted_free(void* p) {
+    if (!p) return;
+    live_bytes.fetch_sub(block_size(p), memory_order_relaxed);
+    free(p);
+}
+
+void* operator new(size_t size) { return counted_alloc(size, 0); }
+void* operator new[](size_t size) { return counted_alloc(size, 0); }
+void* operator new(size_t size, align_val_t al) { return counted_alloc(size, static_cast<size_t>(al)); }
+void* operator new[](size_t size, align_val_t al) { return counted_alloc(size, static_cast<size_t>(al)); }
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t) noexcept { counted_free(p); }
+void operator delete(void* p, align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { counted_free(p); }
+
+#else
+
+static constexpr bool heap_tracking = false;
+
+#endif // BENCH_HEAP_TRACKING
+
+static vector<int> parse_list(const string& text) {
+    vector<int> values;
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ',')) {
+        if (!item.empty()) values.push_back(atoi(item.c_str()));
+    }
+    return values;
+}
+
+// peak resident set of the whole process in MiB, the largest case so far dominates it
+// @return a negative value where it is not available
+static double peak_rss_mib() {
+#if !defined(BENCH_PROCESS_RSS)
+    return -1.0;
+#else
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+#endif
+}
+
+// right-aligned MiB value, "-" where it is not measured
+static void print_mib(double mib, int width) {
+    if (mib < 0.0) printf(" %*s", width, "-");
+    else printf(" %*.1f", width, mib);
+}
+
+// deterministic board with a weak predator-prey style coupling between neighbouring species
+static SimulationConfig make_case(int size, int species, DiffusionMethod method, BoundaryCondition bc, int steps, int threads) {
+    SimulationConfig config;
+    resize_config(config, species, size, size);
+    for (int i = 0; i < species; i++) {
+        config.coefficients[i][i] = -0.01;
+        if (i > 0) config.coefficients[i][i - 1] = 0.002;
+        if (i + 1 < species) config.coefficients[i][i + 1] = -0.001;
+        config.dispersion[i] = 0.05 + 0.02 * (i % 5);
+    }
+    uint32_t seed = 12345;
+    for (int k = 0; k < species; k++) {
+        double* plane = config.initial.plane(k);
+        for (size_t i = 0; i < config.initial.plane_size(); i++) {
+            seed = seed * 1664525u + 1013904223u;
+            plane[i] = (seed >> 8) % 1000 / 10.0;
+        }
+    }
+    config.method = method;
+    config.boundary = bc;
+    config.delta_time = 0.5;  // explicit stays stable with D <= 0.13
+    config.steps = steps;
+    config.threads = threads;
+    return config;
+}
+
+static void print_usage(const char* argv0) {
+    cerr << "Usage: " << argv0 << " [options]\n"
+         << "  --sizes LIST       square board sizes (default 64,256,1024)\n"
+         << "  --species LIST     species counts (default 1,3,8)\n"
+         << "  --methods LIST     explicit,adi (default both)\n"
+         << "  --boundaries LIST  dirichlet,neumann (default both)\n"
+         << "  --cells N          simulated cells per case, sets the steps (default 2e8, 3..1000 steps)\n"
+         << "  --threads N        solver threads, 0 = every core (default 1)\n";
+}
+
+int main(int argc, char** argv) {
+    vector<int> sizes = {64, 256, 1024};
+    vector<int> species_counts = {1, 3, 8};
+    vector<DiffusionMethod> methods = {DIFFUSION_EXPLICIT, DIFFUSION_ADI};
+    vector<BoundaryCondition> boundaries = {BC_DIRICHLET, BC_NEUMANN};
+    double cells_per_case = 2e8;
+    int threads = 1;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        auto value = [&]() -> string {
+            if (i + 1 >= argc) {
+                cerr << "Missing value for " << arg << endl;
+                exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "--sizes") sizes = parse_list(value());
+        else if (arg == "--species") species_counts = parse_list(value());
+        else if (arg == "--methods") {
+            string list = value();
+            methods.clear();
+            if (list.find("explicit") != string::npos) methods.push_back(DIFFUSION_EXPLICIT);
+            if (list.find("adi") != string::npos) methods.push_back(DIFFUSION_ADI);
+        } else if (arg == "--boundaries") {
+            string list = value();
+            boundaries.clear();
+            if (list.find("dirichlet") != string::npos) boundaries.push_back(BC_DIRICHLET);
+            if (list.find("neumann") != string::npos) boundaries.push_back(BC_NEUMANN);
+        } else if (arg == "--cells") cells_per_case = atof(value().c_str());
+        else if (arg == "--threads") threads = atoi(value().c_str());
+        else if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            cerr << "Unknown option " << arg << endl;
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    cout << "SimDynamiX solver benchmark, " << ThreadPool::resolve_threads(threads) << " thread(s)"
+         << (profile_enabled ? "" : ", phase timers compiled out") << endl;
+    printf("%6s %3s %-8s %-9s %6s %12s %10s %12s %10s %13s  phases (%% of step time)\n",
+           "size", "k", "method", "boundary", "steps", "ns/cell/step", "allocs", "alloc MiB", "heap MiB", "proc peak MiB");
+
+    for (int size : sizes) {
+        for (int s : species_counts) {
+            for (DiffusionMethod method : methods) {
+                for (BoundaryCondition bc : boundaries) {
+                    if (size < 1 || s < 1) continue;
+                    const double cells = static_cast<double>(size) * size * s;
+                    const int steps = static_cast<int>(min(1000.0, max(3.0, cells_per_case / cells)));
+                    SimulationConfig config = make_case(size, s, method, bc, steps, threads);
+
+                    // warm-up: thread pool, scratch buffers and factorizations
+                    SimulationConfig warmup = config;
+                    warmup.steps = 1;
+                    runSimulation(warmup, [](int, const Field&) { return true; });
+
+                    profile_reset();
+                    allocations.store(0);
+                    allocated_bytes.store(0);
+                    // the case's fields and solver buffers are live by now, the warm-up allocated them
+                    peak_live_bytes.store(live_bytes.load());
+                    const auto start = chrono::steady_clock::now();
+                    runSimulation(config, [](int, const Field&) { return true; });
+                    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                    const uint64_t allocs = allocations.load();
+                    const double alloc_mib = allocated_bytes.load() / (1024.0 * 1024.0);
+                    const double heap_mib = peak_live_bytes.load() / (1024.0 * 1024.0);
+
+                    printf("%6d %3d %-8s %-9s %6d %12.3f", size, s, diffusion_method_name(method), boundary_condition_name(bc), steps, seconds * 1e9 / (cells * steps));
+                    if (heap_tracking) printf(" %10llu", static_cast<unsigned long long>(allocs));
+                    else printf(" %10s", "-");
+                    print_mib(heap_tracking ? alloc_mib : -1.0, 12);
+                    print_mib(heap_tracking ? heap_mib : -1.0, 10);
+                    print_mib(peak_rss_mib(), 13);
+                    printf(" ");
+                    if (profile_enabled) {
+                        const ProfileTotals totals = profile_snapshot();
+                        for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+                            if (totals.calls[p] == 0) continue;
+                            printf(" %s %.0f%%", profile_phase_name(static_cast<ProfilePhase>(p)), 100.0 * totals.nanoseconds[p] / (seconds * 1e9));
+                        }
+                    }
+                    printf("\n");
+                    fflush(stdout);
+                }
+            }
+        }
+    }
+    return 0;
+}
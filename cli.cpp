@@ -0,0 +1,214 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "third_party/Numerical.h"
+#include "third_party/Presets.h"
+#include "third_party/Profiler.h"
+#include "third_party/SimConfig.h"
+#include "third_party/ThreadPool.h"
+#include "third_party/TrajectoryStore.h"
+
+// headless runner: loads a preset and/or scenario file, runs it and streams the states to a trajectory file
+
+using namespace std;
+
+static void print_usage(const char* argv0) {
+    cerr << "Usage: " << argv0 << " [options]\n"
+         << "  --preset NAME|INDEX      start from a preset (see --list-presets)\n"
+         << "  --config FILE            apply a scenario file (after the preset)\n"
+         << "  --width N, --height N    board size (default 100x100)\n"
+         << "  --steps N                number of timesteps\n"
+         << "  --dt X                   time step\n"
+         << "  --method explicit|adi    diffusion method\n"
+         << "  --boundary dirichlet|neumann\n"
+         << "  --integrator lie|strang|imex  time integration (default lie)\n"
+         << "  --adaptive TOL           error controlled steps with tolerance TOL, needs imex; dt is the output interval\n"
+         << "  --threads N              solver threads, 0 = every core (default 1)\n"
+         << "  --output FILE            trajectory output (default simdynamix.sdx)\n"
+         << "  --stride N               record every N-th step (default 1)\n"
+         << "  --float32                store values as float32\n"
+         << "  --delta                  delta encode frames against the previous one\n"
+         << "  --keyframe N             raw frame every N recorded frames with --delta (default 16)\n"
+         << "  --info FILE              print the frames of a trajectory file and exit\n"
+         << "  --list-presets           print the preset names and exit\n";
+}
+
+// prints the header and per frame the population range of every species
+static int print_info(const string& path) {
+    TrajectoryReader reader;
+    string error;
+    if (!reader.open(path, error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    const StoreHeader& header = reader.header();
+    cout << path << ": " << reader.species() << " species on " << reader.width() << "x" << reader.height()
+         << ", dt " << reader.delta_time() << ", " << reader.size() << " frames, stride " << header.stride
+         << ", " << (header.precision ? "float32" : "float64") << (header.encoding ? " delta" : " raw") << endl;
+    for (size_t t = 0; t < reader.size(); t++) {
+        // the statistics are stored with every frame, the frames themselves are never paged in
+        const FrameStats* stats = reader.stats(t);
+        cout << "  step " << reader.step(t);
+        for (int k = 0; k < reader.species(); k++) cout << "  [" << stats[k].min << ", " << stats[k].max << "] total " << stats[k].sum;
+        cout << endl;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    string preset, config_path, output = "simdynamix.sdx";
+    int width = 100, height = 100;
+    int steps = 0;
+    int threads = 0;
+    bool set_steps = false, set_threads = false, set_dt = false;
+    double dt = 0.0;
+    double tolerance = -1.0;
+    string method, boundary, integrator;
+    TrajectoryOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        auto value = [&]() -> string {
+            if (i + 1 >= argc) {
+                cerr << "Missing value for " << arg << endl;
+                exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "--preset") preset = value();
+        else if (arg == "--config") config_path = value();
+        else if (arg == "--width") width = atoi(value().c_str());
+        else if (arg == "--height") height = atoi(value().c_str());
+        else if (arg == "--steps") {
+            steps = atoi(value().c_str());
+            set_steps = true;
+        } else if (arg == "--dt") {
+            dt = atof(value().c_str());
+            set_dt = true;
+        } else if (arg == "--threads") {
+            threads = atoi(value().c_str());
+            set_threads = true;
+        } else if (arg == "--method") method = value();
+        else if (arg == "--boundary") boundary = value();
+        else if (arg == "--integrator") integrator = value();
+        else if (arg == "--adaptive") tolerance = atof(value().c_str());
+        else if (arg == "--output") output = value();
+        else if (arg == "--stride") options.stride = atoi(value().c_str());
+        else if (arg == "--float32") options.float32 = true;
+        else if (arg == "--delta") options.delta = true;
+        else if (arg == "--keyframe") options.keyframe_interval = atoi(value().c_str());
+        else if (arg == "--info") return print_info(value());
+        else if (arg == "--list-presets") {
+            init_presets();
+            const auto& names = get_preset_names();
+            for (int p = 0; p < (int)names.size(); p++) cout << p << ": " << names[p] << endl;
+            return 0;
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            cerr << "Unknown option " << arg << endl;
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+    if (width < 1 || height < 1) {
+        cerr << "Board size must be at least 1x1" << endl;
+        return 2;
+    }
+    if (options.stride < 1 || options.keyframe_interval < 1) {
+        cerr << "Stride and keyframe interval must be at least 1" << endl;
+        return 2;
+    }
+
+    SimulationConfig config;
+    resize_config(config, 0, height, width);
+    if (!preset.empty()) {
+        int index = find_preset(preset);
+        if (index < 0 && preset.find_first_not_of("0123456789") == string::npos) index = atoi(preset.c_str());
+        if (!build_preset(index, width, height, config)) {
+            cerr << "Unknown preset " << preset << endl;
+            return 2;
+        }
+    }
+    string error;
+    if (!config_path.empty() && !load_config_file(config_path, config, error)) {
+        cerr << error << endl;
+        return 2;
+    }
+    // out-of-range values are rejected by validate_config below, not skipped
+    if (set_steps) config.steps = steps;
+    if (set_dt) config.delta_time = dt;
+    if (set_threads) config.threads = threads;
+    if (!method.empty()) {
+        if (method == "explicit") config.method = DIFFUSION_EXPLICIT;
+        else if (method == "adi") config.method = DIFFUSION_ADI;
+        else { cerr << "Unknown method " << method << endl; return 2; }
+    }
+    if (!boundary.empty()) {
+        if (boundary == "dirichlet") config.boundary = BC_DIRICHLET;
+        else if (boundary == "neumann") config.boundary = BC_NEUMANN;
+        else { cerr << "Unknown boundary condition " << boundary << endl; return 2; }
+    }
+    if (!integrator.empty() && !parse_integrator(integrator, config.integrator)) {
+        cerr << "Unknown integrator " << integrator << endl;
+        return 2;
+    }
+    if (tolerance >= 0.0) {
+        config.adaptive = tolerance > 0.0;
+        if (config.adaptive) config.tolerance = tolerance;
+    }
+    if (!validate_config(config, error)) {
+        cerr << "Invalid configuration: " << error << endl;
+        return 2;
+    }
+
+    TrajectoryWriter writer;
+    if (!writer.open(output, config, options, error)) {
+        cerr << error << endl;
+        return 1;
+    }
+
+    cout << "Simulating " << config.species() << " species on " << config.width << "x" << config.height
+         << ", " << config.steps << " steps, dt " << config.delta_time << ", "
+         << diffusion_method_name(config.method) << "/" << boundary_condition_name(config.boundary)
+         << ", " << integrator_name(config.integrator) << (config.adaptive ? " adaptive" : "")
+         << ", " << ThreadPool::resolve_threads(config.threads) << " thread(s)" << endl;
+
+    profile_reset();
+    const auto start = chrono::steady_clock::now();
+    const int report_every = max(1, config.steps / 10);
+    IntegrationStats integration;
+    const bool ok = runSimulation(config, [&](int t, const Field& state) {
+        // no point in simulating further once the disk is full
+        if (!writer.write(t, state)) return false;
+        if (t > 0 && (t % report_every == 0 || t == config.steps)) {
+            double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "  step " << t << "/" << config.steps << " (" << elapsed << " s)" << endl;
+        }
+        return true;
+    }, &integration);
+    const bool closed = writer.close();
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!ok || !closed) {
+        cerr << "Writing " << output << " failed" << endl;
+        return 1;
+    }
+    cout << "Wrote " << writer.frames() << " frames (" << writer.bytes_written() << " bytes) to " << output << endl;
+    if (config.adaptive) {
+        cout << integration.accepted << " steps accepted, " << integration.rejected << " rejected, step size "
+             << integration.min_step << " .. " << integration.max_step << endl;
+    }
+    if (profile_enabled) {
+        const ProfileTotals totals = profile_snapshot();
+        for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+            if (totals.calls[p] == 0) continue;
+            printf("  %-20s %10.1f ms %5.1f%%\n", profile_phase_name(static_cast<ProfilePhase>(p)), totals.nanoseconds[p] / 1e6, 100.0 * totals.nanoseconds[p] / (seconds * 1e9));
+        }
+    }
+    return 0;
+}
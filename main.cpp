@@ -64,16 +64,13 @@ void renderSimulation() {
     ImGui::EndChild();
 
     if (ImGui::Button("Stop Simulation")) {
+        cancelCalculations();
         // set the board to the initial state steps[0]
-        for (int k = 0; k < steps[0].size(); k++) {
-            for (int y = 0; y < steps[0][0].size(); y++) {
-                for (int x = 0; x < steps[0][0][0].size(); x++) {
-                    board[y][x][k] = steps[0][k][y][x];
-                }
-            }
-        }
-        // empty the steps vector
-        steps.clear();
+        if (!steps.empty()) board.copy_from(steps[0]);
+        // drop the recorded runs, closing a reader deletes its temporary file
+        steps.close();
+        steps_explicit.close();
+        steps_adi.close();
         current = CONFIGURATION;
     }
 
@@ -151,6 +148,8 @@ int main() {
     }
 
     // Cleanup
+    cancelCalculations();
+    releaseHeatmapTextures();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
 
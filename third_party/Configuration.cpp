@@ -6,9 +6,10 @@
 #include <vector>
 #include <sstream>
 #include "./Species.h"
-#include "./Numerical.h"
+#include "./Simulation.h"
 #include "./settings.h"
 #include "./Presets.h"
+#include "./ThreadPool.h"
 
 
 using namespace std;
@@ -16,36 +17,14 @@ using namespace std;
 void config_board_size_species() {
     int board_width_slider = board_width;
     if (ImGui::SliderInt("Board Width", &board_width_slider, 1, BOARD_LIMIT)) {
-        if (board_width_slider > board_width) {
-            // add board_width_slider - board_width els to every arr
-            for (auto & i : board) {
-                for (int j = 0; j < board_width_slider-board_width; j++) {
-                    i.emplace_back(15, 0.0);
-                }
-            }
-        } else {
-            // remove board_width - board_width_slider elements
-            for (auto & i : board) {
-                for (int j = 0; j < board_width-board_width_slider; j++) {
-                    i.pop_back();
-                }
-            }
-        }
+        // keeps the populations of the remaining cells, new columns start empty
+        board.resize(board.species(), board_height, board_width_slider);
         board_width = board_width_slider;
     }
     int board_height_slider = board_height;
     if (ImGui::SliderInt("Board Height", &board_height_slider, 1, BOARD_LIMIT)) {
-        if (board_height_slider > board_height) {
-            // add board_height_slider - board_height rows
-            for (int j = 0; j < board_height_slider-board_height; j++) {
-                board.emplace_back(board_width, vector<double>(15, 0.0));
-            }
-        } else {
-            // remove board_height - board_height_slider rows
-            for (int j = 0; j < board_height - board_height_slider; j++) {
-                board.pop_back();
-            }
-        }
+        // keeps the populations of the remaining cells, new rows start empty
+        board.resize(board.species(), board_height_slider, board_width);
         board_height = board_height_slider;
     }
 
@@ -76,6 +55,26 @@ void config_species_list() {
     }
 }
 
+// loads preset `index` into the configuration screen, keeping the board size
+static void apply_preset(int index) {
+    SimulationConfig config;
+    if (!build_preset(index, board_width, board_height, config)) return;
+    const auto& preset_colors = get_preset_colors(index);
+    const int s = config.species();
+    species.clear();
+    for (int i = 0; i < s; ++i) species.emplace_back(config.species_names[i], preset_colors[i % (int)preset_colors.size()]);
+    coefficients.assign(15, std::vector<double>(15, 0.0));
+    for (int i = 0; i < s; ++i) for (int j = 0; j < s; ++j) coefficients[i][j] = config.coefficients[i][j];
+    dispersion_coefficients.assign(15, 0.0);
+    for (int i = 0; i < s; ++i) dispersion_coefficients[i] = config.dispersion[i];
+    boundary_condition = config.boundary;
+    diffusion_method = config.method;
+    delta_time = config.delta_time;
+    number_steps_t = config.steps;
+    // initialize board
+    board.copy_from(config.initial.view());
+}
+
 void config_dynamics() {
     // Presets
     static bool presets_init = false;
@@ -113,13 +112,30 @@ void config_dynamics() {
     ImGui::Combo("Boundary Condition", &bcIndex, bcLabels, IM_ARRAYSIZE(bcLabels));
     boundary_condition = static_cast<BoundaryCondition>(bcIndex);
 
+    const char* integratorLabels[] = {"Lie splitting", "Strang splitting", "IMEX Runge-Kutta"};
+    int integratorIndex = static_cast<int>(integrator);
+    ImGui::Combo("Integrator", &integratorIndex, integratorLabels, IM_ARRAYSIZE(integratorLabels));
+    integrator = static_cast<Integrator>(integratorIndex);
+
     ImGui::InputDouble("Delta t", &delta_time, 0.0, 0.0, "%.3f", ImGuiInputTextFlags_CharsDecimal);
     delta_time = std::max(0.0001, delta_time);
 
+    // the IMEX scheme carries an error estimate, delta t becomes the output interval
+    if (integrator == INTEGRATOR_IMEX) {
+        ImGui::Checkbox("Adaptive steps", &adaptive_steps);
+        if (adaptive_steps) {
+            ImGui::InputDouble("Tolerance", &step_tolerance, 0.0, 0.0, "%.1e", ImGuiInputTextFlags_CharsScientific);
+            step_tolerance = std::clamp(step_tolerance, 1e-10, 1.0);
+        }
+    }
+
+    ImGui::InputInt("Threads (0 = all cores)", &solver_threads);
+    solver_threads = std::clamp(solver_threads, 0, ThreadPool::max_threads());
+
     ImGui::Checkbox("Compare Explicit vs ADI (side-by-side)", &compare_methods);
 
     // Explicit stability hint for fd scheme (rule of thumb: D*dt <= 0.25 for h=1)
-    if (diffusion_method == DIFFUSION_EXPLICIT) {
+    if (diffusion_method == DIFFUSION_EXPLICIT && integrator != INTEGRATOR_IMEX) {
         double maxD = 0.0;
         for (int i = 0; i < species.size(); ++i) maxD = std::max(maxD, (double)dispersion_coefficients[i]);
         if (maxD * delta_time > 0.25) {
@@ -165,10 +181,11 @@ void config_dynamics() {
         ImGui::EndTable();
     }
 
-    // TODO set max 2000 for later
-    // set min = 1 and max = 2000
+    // runs are streamed to disk, long runs only cost disk space
     ImGui::InputInt("Timesteps", &number_steps_t);
-    number_steps_t = std::clamp(number_steps_t, 1, 2000);
+    number_steps_t = std::clamp(number_steps_t, 1, 100000);
+    ImGui::InputInt("Snapshot stride", &snapshot_stride);
+    snapshot_stride = std::clamp(snapshot_stride, 1, number_steps_t);
     if (ImGui::Button("Simulate")) {
         prepareCalculations();
         current = SIMULATION;
@@ -197,7 +214,7 @@ void board_render() {
                 ostringstream oss;
 
                 for (size_t i = 0; i < species.size(); ++i) {
-                    oss << static_cast<int>(std::round(board[row][col][i]));
+                    oss << static_cast<int>(std::round(board(i, row, col)));
                     if (i < species.size()-1) {
                         oss<<",";
                     }
@@ -223,8 +240,8 @@ void board_render() {
         for (int i = 0; i < species.size(); i++) {
             ImGui::PushStyleColor(ImGuiCol_Text, HexToImVec4(colors[i]));
             // checks needed so that in case of resizing, doesnt crash
-            if (selected_box != -1 && y < board.size() && x < board[0].size()) {
-                ImGui::InputDouble(species[i].name.c_str(), &board[y][x][i], 0.0, 0.0, "%.3f", ImGuiInputTextFlags_CharsDecimal);
+            if (selected_box != -1 && y < board.height() && x < board.width()) {
+                ImGui::InputDouble(species[i].name.c_str(), &board(i, y, x), 0.0, 0.0, "%.3f", ImGuiInputTextFlags_CharsDecimal);
             } else {
                 double myVal = 0.0;
                 ImGui::InputDouble(species[i].name.c_str(), &myVal, 0.0, 0.0, "%.3f", ImGuiInputTextFlags_CharsDecimal);
@@ -0,0 +1,136 @@
+#ifndef FIELD_H
+#define FIELD_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <vector>
+
+// every species plane starts on its own cache line
+#define FIELD_ALIGNMENT 64
+
+// allocator handing out FIELD_ALIGNMENT aligned blocks for the field storage
+template <typename T>
+struct AlignedAllocator {
+    using value_type = T;
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(FIELD_ALIGNMENT)));
+    }
+    void deallocate(T* p, std::size_t) {
+        ::operator delete(p, std::align_val_t(FIELD_ALIGNMENT));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+// distance in doubles between two consecutive species planes of a height x width grid,
+// rounded up so that every plane stays FIELD_ALIGNMENT aligned
+inline std::size_t field_plane_stride(int height, int width) {
+    const std::size_t per_line = FIELD_ALIGNMENT / sizeof(double);
+    const std::size_t cells = static_cast<std::size_t>(height) * static_cast<std::size_t>(width);
+    return (cells + per_line - 1) / per_line * per_line;
+}
+
+// non-owning view of `size` values spaced `stride` apart
+// rows of a plane have stride 1, columns have stride width
+template <typename T>
+struct StridedView {
+    T* data = nullptr;
+    int size = 0;
+    std::ptrdiff_t stride = 1;
+
+    T& operator[](int i) const { return data[i * stride]; }
+};
+
+// read-only view of a field in [k][y][x] order, e.g. one recorded timestep
+struct FieldView {
+    const double* data = nullptr;
+    int species = 0;
+    int height = 0;
+    int width = 0;
+    std::size_t plane_stride = 0;
+
+    const double* plane(int k) const { return data + k * plane_stride; }
+};
+
+// populations of all species on the grid, stored species-major ([k][y][x]) in one aligned block
+// every species plane is a contiguous row-major height x width grid
+class Field {
+public:
+    Field() = default;
+    Field(int species, int height, int width) { reset(species, height, width); }
+
+    // reshapes the field and sets every value to 0
+    void reset(int species, int height, int width) {
+        species_ = species;
+        height_ = height;
+        width_ = width;
+        plane_stride_ = field_plane_stride(height, width);
+        data_.assign(plane_stride_ * species_, 0.0);
+    }
+
+    // reshapes the field keeping the values of the overlapping region, new cells are 0
+    void resize(int species, int height, int width) {
+        Field resized(species, height, width);
+        const int ks = std::min(species, species_);
+        const int ys = std::min(height, height_);
+        const int xs = std::min(width, width_);
+        for (int k = 0; k < ks; k++) {
+            for (int y = 0; y < ys; y++) {
+                std::memcpy(resized.plane(k) + static_cast<std::size_t>(y) * width, plane(k) + static_cast<std::size_t>(y) * width_, xs * sizeof(double));
+            }
+        }
+        *this = std::move(resized);
+    }
+
+    // copies the planes of `src` (same height and width) into the first src.species planes
+    void copy_from(const FieldView& src) {
+        const int ks = std::min(src.species, species_);
+        if (ks <= 0) return;
+        if (src.plane_stride == plane_stride_) {
+            std::memcpy(data_.data(), src.data, ks * plane_stride_ * sizeof(double));
+            return;
+        }
+        // e.g. unpadded frames read back from a trajectory file
+        for (int k = 0; k < ks; k++) std::memcpy(plane(k), src.plane(k), plane_size() * sizeof(double));
+    }
+
+    void fill(double value) { std::fill(data_.begin(), data_.end(), value); }
+
+    int species() const { return species_; }
+    int height() const { return height_; }
+    int width() const { return width_; }
+    std::size_t plane_size() const { return static_cast<std::size_t>(height_) * width_; }
+    std::size_t plane_stride() const { return plane_stride_; }
+
+    double* plane(int k) { return data_.data() + k * plane_stride_; }
+    const double* plane(int k) const { return data_.data() + k * plane_stride_; }
+
+    double& operator()(int k, int y, int x) { return plane(k)[static_cast<std::size_t>(y) * width_ + x]; }
+    double operator()(int k, int y, int x) const { return plane(k)[static_cast<std::size_t>(y) * width_ + x]; }
+
+    double* data() { return data_.data(); }
+    const double* data() const { return data_.data(); }
+    FieldView view() const { return {data_.data(), species_, height_, width_, plane_stride_}; }
+
+private:
+    int species_ = 0;
+    int height_ = 0;
+    int width_ = 0;
+    std::size_t plane_stride_ = 0;
+    AlignedVector<double> data_;
+};
+
+#endif // FIELD_H
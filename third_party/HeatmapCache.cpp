@@ -0,0 +1,102 @@
+#include "HeatmapCache.h"
+#include <algorithm>
+#include <cmath>
+#include "imgui.h"
+#include "implot.h"
+#include <glad/glad.h>
+
+unsigned int HeatmapCache::find(const HeatmapKey& key) {
+    const auto it = index_.find(key);
+    if (it == index_.end()) return 0;
+    touch(it->second);
+    return entries_[it->second].texture;
+}
+
+void HeatmapCache::unlink(int slot) {
+    Entry& e = entries_[slot];
+    if (e.newer >= 0) entries_[e.newer].older = e.older;
+    else newest_ = e.older;
+    if (e.older >= 0) entries_[e.older].newer = e.newer;
+    else oldest_ = e.newer;
+}
+
+void HeatmapCache::touch(int slot) {
+    if (slot == newest_) return;
+    unlink(slot);
+    Entry& e = entries_[slot];
+    e.newer = -1;
+    e.older = newest_;
+    if (newest_ >= 0) entries_[newest_].newer = slot;
+    newest_ = slot;
+    if (oldest_ < 0) oldest_ = slot;
+}
+
+// 256 colors sampled from `colormap`, packed in GL_RGBA byte order
+void HeatmapCache::build_lut(int colormap) {
+    for (int i = 0; i < 256; i++) lut_[i] = ImGui::ColorConvertFloat4ToU32(ImPlot::SampleColormap(i / 255.0f, colormap));
+    lut_colormap_ = colormap;
+}
+
+unsigned int HeatmapCache::upload(const HeatmapKey& key, const double* grid, int height, int width) {
+    if (key.colormap != lut_colormap_) build_lut(key.colormap);
+    const std::size_t cells = static_cast<std::size_t>(height) * width;
+    if (pixels_.size() < cells) pixels_.resize(cells);
+    const double scale = key.scale_max > key.scale_min ? 255.0 / (key.scale_max - key.scale_min) : 0.0;
+    for (std::size_t i = 0; i < cells; i++) {
+        const double v = (grid[i] - key.scale_min) * scale;
+        pixels_[i] = lut_[static_cast<int>(std::clamp(v, 0.0, 255.0))];
+    }
+
+    // as many textures as fit the budget; on huge boards that is only the two most recent ones
+    const std::size_t capacity = std::clamp<std::size_t>(HEATMAP_TEXTURE_BUDGET / std::max<std::size_t>(1, cells * 4), 2, 4096);
+    int index = -1;
+    if (entries_.size() < capacity) {
+        if (entries_.capacity() < capacity) {
+            entries_.reserve(capacity);
+            index_.reserve(capacity);
+        }
+        index = static_cast<int>(entries_.size());
+        // linked in as the oldest entry, touch() below moves it to the front
+        entries_.push_back({key, 0, 0, 0, oldest_, -1});
+        if (oldest_ >= 0) entries_[oldest_].older = index;
+        oldest_ = index;
+        if (newest_ < 0) newest_ = index;
+        index_.emplace(key, index);
+        Entry* slot = &entries_.back();
+        glGenTextures(1, &slot->texture);
+        glBindTexture(GL_TEXTURE_2D, slot->texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    } else {
+        index = oldest_;
+        // moves the map node over to the new key, so eviction allocates nothing
+        auto node = index_.extract(entries_[index].key);
+        node.key() = key;
+        index_.insert(std::move(node));
+        glBindTexture(GL_TEXTURE_2D, entries_[index].texture);
+    }
+    Entry* slot = &entries_[index];
+
+    // reuse the storage of the evicted texture when the grid size matches
+    if (slot->height == height && slot->width == width) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels_.data());
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels_.data());
+        slot->height = height;
+        slot->width = width;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    slot->key = key;
+    touch(index);
+    return slot->texture;
+}
+
+void HeatmapCache::clear() {
+    for (auto& e : entries_) glDeleteTextures(1, &e.texture);
+    entries_.clear();
+    index_.clear();
+    newest_ = -1;
+    oldest_ = -1;
+}
@@ -0,0 +1,75 @@
+#ifndef HEATMAP_CACHE_H
+#define HEATMAP_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// GPU memory the cached heatmap textures may take up
+#define HEATMAP_TEXTURE_BUDGET (256u << 20)
+
+// identifies what a heatmap texture shows
+struct HeatmapKey {
+    const void* source;   // recorded run
+    std::size_t frame;
+    int species;
+    int colormap;
+    double scale_min;
+    double scale_max;
+
+    bool operator==(const HeatmapKey& o) const {
+        return source == o.source && frame == o.frame && species == o.species && colormap == o.colormap
+            && scale_min == o.scale_min && scale_max == o.scale_max;
+    }
+};
+
+struct HeatmapKeyHash {
+    std::size_t operator()(const HeatmapKey& k) const {
+        std::size_t h = std::hash<const void*>()(k.source);
+        for (std::size_t v : {k.frame, static_cast<std::size_t>(k.species), static_cast<std::size_t>(k.colormap),
+                              std::hash<double>()(k.scale_min), std::hash<double>()(k.scale_max)}) {
+            h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        }
+        return h;
+    }
+};
+
+// RGBA textures of recorded (frame, species) grids colored with an ImPlot colormap
+// a texture is uploaded once and reused until it is evicted (least recently used first)
+// or the colormap or color range change; after warm-up drawing allocates nothing
+// lookups go through a hash index, the entries form a doubly linked list in order of use
+class HeatmapCache {
+public:
+    // @return the texture of `key` or 0 if it has not been uploaded
+    unsigned int find(const HeatmapKey& key);
+    // colors the height x width row-major `grid` and uploads it as the texture of `key`
+    unsigned int upload(const HeatmapKey& key, const double* grid, int height, int width);
+    // deletes every texture, needs the GL context (new run, shutdown)
+    void clear();
+
+private:
+    struct Entry {
+        HeatmapKey key;
+        unsigned int texture;
+        int height;
+        int width;
+        int newer;  // neighbours in the use order, -1 at the ends
+        int older;
+    };
+    void build_lut(int colormap);
+    void unlink(int slot);
+    // makes `slot` the most recently used entry
+    void touch(int slot);
+
+    std::vector<Entry> entries_;
+    std::unordered_map<HeatmapKey, int, HeatmapKeyHash> index_;  // key -> slot in entries_
+    int newest_ = -1;
+    int oldest_ = -1;
+    std::vector<uint32_t> pixels_;
+    uint32_t lut_[256] = {};
+    int lut_colormap_ = -1;
+};
+
+#endif // HEATMAP_CACHE_H
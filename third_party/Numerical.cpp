@@ -1,279 +1,273 @@
 #include "Numerical.h"
 #include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
 #include <vector>
-#include "./settings.h"
+#include "./Profiler.h"
+#include "./ThreadPool.h"
+#include "./Reaction.h"
+#include "./Tridiagonal.h"
+
+using namespace std;
 
 
 vector<vector<double>> generateDispersionMatrix(int n);
 vector<double> matrixVectorMultiplication(vector<double> vec, vector<vector<double>> matrix);
-vector<double> computePopulation1DimDispersion(vector<double> populationVec);
-vector<vector<double>> computeSinglePopulationDispersion(vector<vector<double>> population, double dispersionCoefficient);
+static inline double computePopulation1DimDispersion(StridedView<const double> populationVec, int i);
 
 // ADI helpers (Crank–Nicolson)
-static void build_tridiagonal_neumann(int n, double r, std::vector<double>& a, std::vector<double>& b, std::vector<double>& c);
-static void build_tridiagonal_dirichlet(int n, double r, std::vector<double>& a, std::vector<double>& b, std::vector<double>& c);
-static void thomas_solve_inplace(std::vector<double>& a, std::vector<double>& b, std::vector<double>& c, std::vector<double>& d);
-static inline double laplace_neumann_y(const std::vector<std::vector<double>>& u, int y, int x);
-static inline double laplace_neumann_x(const std::vector<std::vector<double>>& u, int y, int x);
-static std::vector<std::vector<double>> computeSinglePopulationDispersionADI(const std::vector<std::vector<double>>& population, double diffusionCoefficient);
-static std::vector<std::vector<double>> computeSinglePopulationDispersionExplicitNeumann(const std::vector<std::vector<double>>& population);
-
-
-// computes the dispersed populations
-// @param populations the populations in a row-col-pop format
-// @param dispersionCoefficients the coefficients of dispersion for each population
-void computePopulationsDispersion(vector<vector<vector<double>>> & populations, vector<double> dispersionCoefficients) {
-    // transform row-col-pop to pop-row-col
-    vector<vector<vector<double>>> populationsTransformed = vector(populations[0][0].size(), vector(populations.size(), vector(populations[0].size(), 0.0)));
-    for (int pop = 0; pop < populations[0][0].size(); pop++) {
-        for (int row = 0; row < populations.size(); row++) {
-            for (int col = 0; col < populations[0].size(); col++) {
-                populationsTransformed[pop][row][col] = populations[row][col][pop];
-            }
-        }
-    }
-
-    // compute dispersion increment for every population
-    for (int pop = 0; pop < populations[0][0].size(); pop++) {
-        if (diffusion_method == DIFFUSION_ADI) {
-            populationsTransformed[pop] = computeSinglePopulationDispersionADI(populationsTransformed[pop], static_cast<double>(dispersionCoefficients[pop]));
-        } else {
-            if (boundary_condition == BC_NEUMANN) {
-                // Neumann explicit increment scaled by D
-                auto inc = computeSinglePopulationDispersionExplicitNeumann(populationsTransformed[pop]);
-                for (int y = 0; y < (int)inc.size(); ++y) {
-                    for (int x = 0; x < (int)inc[0].size(); ++x) {
-                        inc[y][x] = static_cast<int>(inc[y][x] * dispersionCoefficients[pop]);
-                    }
-                }
-                populationsTransformed[pop] = std::move(inc);
-            } else {
-                populationsTransformed[pop] = computeSinglePopulationDispersion(populationsTransformed[pop], dispersionCoefficients[pop]);
-            }
-        }
-    }
-
-    // transform pop-row-col to row-col-pop and add increment
-    for (int pop = 0; pop < (int)populationsTransformed.size(); pop++) {
-        for (int row = 0; row < (int)populationsTransformed[0].size(); row++) {
-            for (int col = 0; col < (int)populationsTransformed[0][0].size(); col++) {
-                populations[row][col][pop] = std::max(populations[row][col][pop] + populationsTransformed[pop][row][col], 0.0);
-            }
-        }
+static inline double laplace_neumann(StridedView<const double> u, int i);
+static inline double laplace_dirichlet(StridedView<const double> u, int i);
+
+// rows solved together by one batched x-direction sweep (one cache line of doubles per x)
+#define ADI_ROW_BLOCK 8
+// columns solved together by one batched y-direction sweep
+#define ADI_COLUMN_BLOCK 64
+
+// scratch buffers of one worker thread, never shared between workers
+struct Workspace {
+    std::vector<double> block; // ADI_ROW_BLOCK interleaved rows, [x][row]
+    std::vector<double> zeros; // the row outside a Dirichlet boundary
+};
+
+// thread pool and buffers reused by every step of every run
+struct SolverState {
+    std::unique_ptr<ThreadPool> pool;
+    std::vector<Workspace> workspaces;   // indexed by worker
+    Field increment;                     // dispersion increment of every population
+    Field u_star;                        // ADI state after the first half-step
+    Field reacted;                       // second buffer of the reaction step
+    Field start;                         // state at the beginning of a Heun or IMEX step
+    Field stage;                         // Heun second stage, IMEX stage U2
+    Field stage_rhs;                     // IMEX right-hand side of stage U2
+    std::vector<double> errors;          // per worker maximum of the IMEX error estimate
+    TridiagonalCache tridiagonal;        // factorized (I - r T) by size, r and boundary condition
+    std::vector<std::shared_ptr<const TridiagonalFactorization>> rows; // per population, x-direction system
+    std::vector<std::shared_ptr<const TridiagonalFactorization>> cols; // per population, y-direction system
+    // IMEX stage systems, refactorized in place for every step size instead of going through the cache
+    std::vector<TridiagonalFactorization> implicit_rows;
+    std::vector<TridiagonalFactorization> implicit_cols;
+};
+
+// the shared solver state with a pool of `threads` workers (<= 0: every core)
+// the pool is only rebuilt when the number of workers changes
+static SolverState& solver_state(int threads) {
+    static SolverState state;
+    const int n = ThreadPool::resolve_threads(threads);
+    if (!state.pool || state.pool->size() != n) {
+        state.pool.reset();
+        state.pool = std::make_unique<ThreadPool>(n);
+        state.workspaces.assign(n, Workspace{});
+        state.errors.assign(n, 0.0);
     }
+    return state;
 }
 
-// computes the dispersion for a single population
-// @param population the population in a row-col format
-// @param dispersionCoefficient the coefficient of dispersion
-// @return the dispersed population
-vector<vector<double>> computeSinglePopulationDispersion(vector<vector<double>> population, double dispersionCoefficient) {
-    // compute the 1D dispersion for every row
-    // newPopulationCols is in a row-col format
-    vector<vector<double>> newPopulationRows = vector(population.size(), vector(population[0].size(), 0.0));
-    for (int row = 0; row < population.size(); row++) {
-        newPopulationRows[row] = computePopulation1DimDispersion(population[row]);
+// a fresh field on a shape change, so a smaller board does not keep the buffers of the largest one run so far
+static void reshape(Field& field, const Field& like) {
+    if (field.species() != like.species() || field.height() != like.height() || field.width() != like.width()) {
+        field = Field(like.species(), like.height(), like.width());
     }
+}
 
-    // compute the 1D dispersion for every column
-    // newPopulationCols is in a col-row format
-    vector<vector<double>> newPopulationCols = vector(population[0].size(), vector(population.size(), 0.0));
-    for (int col = 0; col < population[0].size(); col++) {
-        vector<double> populationCol = vector(population.size(), 0.0);
-        for (int row = 0; row < population.size(); row++) {
-            populationCol[row] = population[row][col];
-        }
-        newPopulationCols[col] = computePopulation1DimDispersion(populationCol);
+// explicit increment of row y, value outside the domain is 0
+static void computeRowDispersion(const double* population, double* increment, int H, int W, int y, double dispersionCoefficient) {
+    StridedView<const double> row{population + static_cast<std::size_t>(y) * W, W, 1};
+    double* inc = increment + static_cast<std::size_t>(y) * W;
+    for (int x = 0; x < W; ++x) {
+        StridedView<const double> col{population + x, H, W};
+        inc[x] = (computePopulation1DimDispersion(row, x) + computePopulation1DimDispersion(col, y)) * dispersionCoefficient;
     }
+}
 
-    // combine the 1D dispersions to yield the 2D dispersion
-    vector<vector<double>> newPopulation = vector(population.size(), vector(population[0].size(), 0.0));
-    for (int row = 0; row < population.size(); row++) {
-        for (int col = 0; col < population[0].size(); col++) {
-            newPopulation[row][col] = (newPopulationRows[row][col] + newPopulationCols[col][row]) * dispersionCoefficient;
-        }
+// explicit increment of row y with Neumann BC (zero flux)
+static void computeRowDispersionExplicitNeumann(const double* population, double* increment, int H, int W, int y, double dispersionCoefficient) {
+    StridedView<const double> row{population + static_cast<std::size_t>(y) * W, W, 1};
+    double* inc = increment + static_cast<std::size_t>(y) * W;
+    for (int x = 0; x < W; ++x) {
+        StridedView<const double> col{population + x, H, W};
+        inc[x] = (laplace_neumann(col, y) + laplace_neumann(row, x)) * dispersionCoefficient;
     }
-    return newPopulation;
 }
 
-// --- ADI (Crank–Nicolson) diffusion producing increments (u^{n+1} - u^n) ---
-static std::vector<std::vector<double>> computeSinglePopulationDispersionADI(const std::vector<std::vector<double>>& population, double diffusionCoefficient) {
-    const int H = static_cast<int>(population.size());
-    const int W = H > 0 ? static_cast<int>(population[0].size()) : 0;
-    if (H == 0 || W == 0) return {};
-
-    // Convert to double for numerics
-    std::vector<std::vector<double>> u = population;
-
-    const double dt = delta_time; // configurable
-    const double h2 = 1.0;  // grid spacing squared
-    const double r = (diffusionCoefficient * dt) / (2.0 * h2);
-
-    // First half-step: (I - r T_x) U* = (I + r T_y) U^n
-    static std::vector<double> a, b, c, rhs;
-    a.resize(std::max(W, H));
-    b.resize(std::max(W, H));
-    c.resize(std::max(W, H));
-    rhs.resize(std::max(W, H));
-    std::vector<std::vector<double>> u_star(H, std::vector<double>(W, 0.0));
-
-    // Pre-build x-direction system coefficients (depends only on W and r)
-    if (boundary_condition == BC_NEUMANN) build_tridiagonal_neumann(W, r, a, b, c);
-    else build_tridiagonal_dirichlet(W, r, a, b, c);
-
-    for (int y = 0; y < H; ++y) {
-        // RHS = (I + r T_y) applied to u at (y, x)
-        for (int x = 0; x < W; ++x) {
-            double ly;
-            if (boundary_condition == BC_NEUMANN) {
-                ly = laplace_neumann_y(u, y, x);
-            } else {
-                double up = (y > 0) ? u[y - 1][x] : 0.0;
-                double down = (y < H - 1) ? u[y + 1][x] : 0.0;
-                ly = up - 2.0 * u[y][x] + down;
+// implicit x-direction sweep over rows [y0, y0 + count): (I - r T_x) dst = value + weight * source + rx T_x source + ry T_y source
+// ADI first half-step: value = source = U^n, weight = 0, rx = 0, ry = r; IMEX: value = U, source = base, weight = -1, rx = ry = r
+// the right-hand sides are interleaved as [x][row] so a single batched sweep solves every row of the block
+// dst may be value, each row is only written after the whole block is gathered
+static void sweepRowBlock(const double* value, const double* source, double weight, double rx, double ry, double* dst, int H, int W, int y0, int count, const TridiagonalFactorization& f, BoundaryCondition boundary_condition, Workspace& ws) {
+    const double* zeros = ws.zeros.data();
+    double* block = ws.block.data();
+    auto laplace = boundary_condition == BC_NEUMANN ? laplace_neumann : laplace_dirichlet;
+    for (int l = 0; l < count; ++l) {
+        const int y = y0 + l;
+        const double* val = value + static_cast<std::size_t>(y) * W;
+        const double* row = source + static_cast<std::size_t>(y) * W;
+        // neighbouring rows, mirrored (Neumann) or zero (Dirichlet) outside the domain
+        const double* up = (y > 0) ? row - W : (boundary_condition == BC_NEUMANN ? (H > 1 ? row + W : row) : zeros);
+        const double* down = (y < H - 1) ? row + W : (boundary_condition == BC_NEUMANN ? (H > 1 ? row - W : row) : zeros);
+        if (rx == 0.0) {
+            for (int x = 0; x < W; ++x) {
+                const double ly = up[x] - 2.0 * row[x] + down[x];
+                block[static_cast<std::size_t>(x) * count + l] = val[x] + weight * row[x] + ry * ly;
             }
-            rhs[x] = u[y][x] + r * ly;
+            continue;
         }
-        // Solve (I - r T_x) row system
-        std::vector<double> aa(a.begin(), a.begin() + W);
-        std::vector<double> bb(b.begin(), b.begin() + W);
-        std::vector<double> cc(c.begin(), c.begin() + W);
-        std::vector<double> dd(rhs.begin(), rhs.begin() + W);
-        thomas_solve_inplace(aa, bb, cc, dd);
-        for (int x = 0; x < W; ++x) u_star[y][x] = dd[x];
+        for (int x = 1; x < W - 1; ++x) {
+            const double lx = row[x - 1] - 2.0 * row[x] + row[x + 1];
+            const double ly = up[x] - 2.0 * row[x] + down[x];
+            block[static_cast<std::size_t>(x) * count + l] = val[x] + weight * row[x] + rx * lx + ry * ly;
+        }
+        // only the edge columns need the boundary condition along x
+        StridedView<const double> view{row, W, 1};
+        for (int x : {0, W - 1}) {
+            const double ly = up[x] - 2.0 * row[x] + down[x];
+            block[static_cast<std::size_t>(x) * count + l] = val[x] + weight * row[x] + rx * laplace(view, x) + ry * ly;
+        }
+    }
+    solve_tridiagonal_batch(f, block, count, count);
+    for (int l = 0; l < count; ++l) {
+        double* out = dst + static_cast<std::size_t>(y0 + l) * W;
+        for (int x = 0; x < W; ++x) out[x] = block[static_cast<std::size_t>(x) * count + l];
     }
+}
 
-    // Second half-step: (I - r T_y) U^{n+1} = (I + r T_x) U*
-    // Pre-build y-direction coefficients
-    if (boundary_condition == BC_NEUMANN) build_tridiagonal_neumann(H, r, a, b, c);
-    else build_tridiagonal_dirichlet(H, r, a, b, c);
-    std::vector<std::vector<double>> u_next(H, std::vector<double>(W, 0.0));
-    for (int x = 0; x < W; ++x) {
-        // RHS = (I + r T_x) applied to u_star along x
+// implicit y-direction sweep over columns [x0, x0 + count): (I - r T_y) dst = source + rx T_x source, then dst += weight * add
+// without a source dst already holds the right-hand side
+// ADI second half-step: source = U*, rx = r, add = U^n, weight = -1 leaves u^{n+1} - u^n; IMEX: no source, add = base, weight = 1
+// the columns of a plane are already interleaved (stride W), so they are solved in place inside `dst`
+static void sweepColumnBlock(const double* source, double rx, const double* add, double weight, double* dst, int H, int W, int x0, int count, const TridiagonalFactorization& f, BoundaryCondition boundary_condition) {
+    if (source) {
         for (int y = 0; y < H; ++y) {
-            double lx;
-            if (boundary_condition == BC_NEUMANN) {
-                lx = laplace_neumann_x(u_star, y, x);
-            } else {
-                double left = (x > 0) ? u_star[y][x - 1] : 0.0;
-                double right = (x < W - 1) ? u_star[y][x + 1] : 0.0;
-                lx = left - 2.0 * u_star[y][x] + right;
+            StridedView<const double> row{source + static_cast<std::size_t>(y) * W, W, 1};
+            double* rhs = dst + static_cast<std::size_t>(y) * W;
+            for (int x = x0; x < x0 + count; ++x) {
+                double lx = (boundary_condition == BC_NEUMANN) ? laplace_neumann(row, x) : laplace_dirichlet(row, x);
+                rhs[x] = row[x] + rx * lx;
             }
-            rhs[y] = u_star[y][x] + r * lx;
         }
-        // Solve (I - r T_y) column system
-        std::vector<double> aa(a.begin(), a.begin() + H);
-        std::vector<double> bb(b.begin(), b.begin() + H);
-        std::vector<double> cc(c.begin(), c.begin() + H);
-        std::vector<double> dd(rhs.begin(), rhs.begin() + H);
-        thomas_solve_inplace(aa, bb, cc, dd);
-        for (int y = 0; y < H; ++y) u_next[y][x] = dd[y];
     }
-
-    // Return diffusion increment: u^{n+1} - u^{n}
-    std::vector<std::vector<double>> increment(H, std::vector<double>(W, 0.0));
+    solve_tridiagonal_batch(f, dst + x0, count, W);
     for (int y = 0; y < H; ++y) {
-        for (int x = 0; x < W; ++x) {
-            increment[y][x] = u_next[y][x] - u[y][x];
-        }
+        const std::size_t offset = static_cast<std::size_t>(y) * W;
+        for (int x = x0; x < x0 + count; ++x) dst[offset + x] += weight * add[offset + x];
     }
-    return increment;
 }
 
-// explicit diffusion increment with Neumann BC (zero flux)
-static std::vector<std::vector<double>> computeSinglePopulationDispersionExplicitNeumann(const std::vector<std::vector<double>>& population) {
-    const int H = static_cast<int>(population.size());
-    const int W = H > 0 ? static_cast<int>(population[0].size()) : 0;
-    std::vector<std::vector<double>> inc(H, std::vector<double>(W, 0.0));
-    if (H == 0 || W == 0) return inc;
-    for (int y = 0; y < H; ++y) {
-        for (int x = 0; x < W; ++x) {
-            double up = (y > 0) ? population[y - 1][x] : population[y + 1][x];
-            double down = (y < H - 1) ? population[y + 1][x] : population[y - 1][x];
-            double left = (x > 0) ? population[y][x - 1] : population[y][x + 1];
-            double right = (x < W - 1) ? population[y][x + 1] : population[y][x - 1];
-            inc[y][x] = (up + down + left + right) - 4.0 * population[y][x];
+// computes the dispersed populations in place
+// work is split into (population, row block) and (population, column block) items over the solver pool;
+// every item does the same arithmetic whatever the number of threads, so results are identical to a serial run
+// @param populations the populations in a pop-row-col format
+// @param config supplies the method, boundary condition, time step, thread count and the dispersion of each population
+void computePopulationsDispersion(Field & populations, const SimulationConfig & config) {
+    const vector<double> & dispersionCoefficients = config.dispersion;
+    const int S = populations.species();
+    const int H = populations.height();
+    const int W = populations.width();
+    if (S == 0 || H == 0 || W == 0) return;
+
+    SolverState & state = solver_state(config.threads);
+    ThreadPool & pool = *state.pool;
+    reshape(state.increment, populations);
+
+    if (config.method == DIFFUSION_ADI) {
+        reshape(state.u_star, populations);
+        const double h2 = 1.0;  // grid spacing squared
+        // factorized systems per population, reused while size, r and BC stay the same
+        state.rows.resize(S);
+        state.cols.resize(S);
+        for (int k = 0; k < S; ++k) {
+            const double r = (dispersionCoefficients[k] * config.delta_time) / (2.0 * h2);
+            state.rows[k] = state.tridiagonal.get(W, r, config.boundary);
+            state.cols[k] = state.tridiagonal.get(H, r, config.boundary);
+        }
+        const int row_blocks = (H + ADI_ROW_BLOCK - 1) / ADI_ROW_BLOCK;
+        {
+            SDX_PROFILE_SCOPE(PROFILE_ADI_ROWS);
+            pool.parallel_for(0, S * row_blocks, [&](int begin, int end, int worker) {
+                Workspace & ws = state.workspaces[worker];
+                ws.block.resize(static_cast<std::size_t>(W) * ADI_ROW_BLOCK);
+                ws.zeros.resize(W, 0.0);
+                for (int item = begin; item < end; ++item) {
+                    const int k = item / row_blocks;
+                    const int y0 = (item % row_blocks) * ADI_ROW_BLOCK;
+                    const double r = (dispersionCoefficients[k] * config.delta_time) / (2.0 * h2);
+                    // (I - r T_x) U* = (I + r T_y) U^n
+                    sweepRowBlock(populations.plane(k), populations.plane(k), 0.0, 0.0, r, state.u_star.plane(k), H, W, y0, std::min(ADI_ROW_BLOCK, H - y0), *state.rows[k], config.boundary, ws);
+                }
+            });
+        }
+        const int column_blocks = (W + ADI_COLUMN_BLOCK - 1) / ADI_COLUMN_BLOCK;
+        {
+            SDX_PROFILE_SCOPE(PROFILE_ADI_COLUMNS);
+            pool.parallel_for(0, S * column_blocks, [&](int begin, int end, int) {
+                for (int item = begin; item < end; ++item) {
+                    const int k = item / column_blocks;
+                    const int x0 = (item % column_blocks) * ADI_COLUMN_BLOCK;
+                    const double r = (dispersionCoefficients[k] * config.delta_time) / (2.0 * h2);
+                    // (I - r T_y) U^{n+1} = (I + r T_x) U*, stored as the increment u^{n+1} - u^n
+                    sweepColumnBlock(state.u_star.plane(k), r, populations.plane(k), -1.0, state.increment.plane(k), H, W, x0, std::min(ADI_COLUMN_BLOCK, W - x0), *state.cols[k], config.boundary);
+                }
+            });
         }
+    } else {
+        SDX_PROFILE_SCOPE(PROFILE_DIFFUSION_EXPLICIT);
+        pool.parallel_for(0, S * H, [&](int begin, int end, int) {
+            for (int item = begin; item < end; ++item) {
+                const int k = item / H;
+                if (config.boundary == BC_NEUMANN) {
+                    computeRowDispersionExplicitNeumann(populations.plane(k), state.increment.plane(k), H, W, item % H, dispersionCoefficients[k] * config.delta_time);
+                } else {
+                    computeRowDispersion(populations.plane(k), state.increment.plane(k), H, W, item % H, dispersionCoefficients[k] * config.delta_time);
+                }
+            }
+        });
     }
-    return inc;
-}
-
-static inline double laplace_neumann_y(const std::vector<std::vector<double>>& u, int y, int x) {
-    const int H = static_cast<int>(u.size());
-    // Neumann: mirror at boundaries
-    double up = (y > 0) ? u[y - 1][x] : u[y + 1][x];
-    double down = (y < H - 1) ? u[y + 1][x] : u[y - 1][x];
-    return up - 2.0 * u[y][x] + down;
-}
 
-static inline double laplace_neumann_x(const std::vector<std::vector<double>>& u, int y, int x) {
-    const int W = static_cast<int>(u[0].size());
-    double left = (x > 0) ? u[y][x - 1] : u[y][x + 1];
-    double right = (x < W - 1) ? u[y][x + 1] : u[y][x - 1];
-    return left - 2.0 * u[y][x] + right;
-}
-
-static void build_tridiagonal_neumann(int n, double r, std::vector<double>& a, std::vector<double>& b, std::vector<double>& c) {
-    a.assign(n, 0.0);
-    b.assign(n, 0.0);
-    c.assign(n, 0.0);
-    // For (I - r T) with T having Neumann-modified ends: off-diagonal magnitude doubles at boundaries
-    // Internal nodes: diag = 1 + 2r, off = -r
-    for (int i = 0; i < n; ++i) {
-        b[i] = 1.0 + 2.0 * r;
-        if (i > 0) a[i] = -r;
-        if (i < n - 1) c[i] = -r;
-    }
-    // Neumann adjustment: first and last off-diagonal doubled in magnitude (because T boundary off-diag is 2)
-    if (n >= 2) {
-        c[0] = -2.0 * r;
-        a[n - 1] = -2.0 * r;
+    // add the increments once every population is computed
+    {
+        SDX_PROFILE_SCOPE(PROFILE_DIFFUSION_APPLY);
+        pool.parallel_for(0, S * H, [&](int begin, int end, int) {
+            for (int item = begin; item < end; ++item) {
+                const int k = item / H;
+                const std::size_t offset = static_cast<std::size_t>(item % H) * W;
+                double* out = populations.plane(k) + offset;
+                const double* inc = state.increment.plane(k) + offset;
+                for (int x = 0; x < W; ++x) {
+                    out[x] = std::max(out[x] + inc[x], 0.0);
+                }
+            }
+        });
     }
 }
 
-static void build_tridiagonal_dirichlet(int n, double r, std::vector<double>& a, std::vector<double>& b, std::vector<double>& c) {
-    a.assign(n, 0.0);
-    b.assign(n, 0.0);
-    c.assign(n, 0.0);
-    for (int i = 0; i < n; ++i) {
-        b[i] = 1.0 + 2.0 * r;
-        if (i > 0) a[i] = -r;
-        if (i < n - 1) c[i] = -r;
-    }
-    // Dirichlet BC: nothing special beyond standard tri-diagonal; boundaries remain as set
+// second difference at i, mirroring the missing neighbour at the boundaries (zero flux)
+static inline double laplace_neumann(StridedView<const double> u, int i) {
+    const int n = u.size;
+    double prev = (i > 0) ? u[i - 1] : (n > 1 ? u[i + 1] : u[i]);
+    double next = (i < n - 1) ? u[i + 1] : (n > 1 ? u[i - 1] : u[i]);
+    return prev - 2.0 * u[i] + next;
 }
 
-static void thomas_solve_inplace(std::vector<double>& a, std::vector<double>& b, std::vector<double>& c, std::vector<double>& d) {
-    // a: sub, b: diag, c: super, d: RHS; all size n; a[0] ignored, c[n-1] ignored
-    const int n = static_cast<int>(b.size());
-    for (int i = 1; i < n; ++i) {
-        double m = a[i] / b[i - 1];
-        b[i] -= m * c[i - 1];
-        d[i] -= m * d[i - 1];
-    }
-    d[n - 1] /= b[n - 1];
-    for (int i = n - 2; i >= 0; --i) {
-        d[i] = (d[i] - c[i] * d[i + 1]) / b[i];
-    }
+// second difference at i, the value outside the domain is 0
+static inline double laplace_dirichlet(StridedView<const double> u, int i) {
+    const int n = u.size;
+    double prev = (i > 0) ? u[i - 1] : 0.0;
+    double next = (i < n - 1) ? u[i + 1] : 0.0;
+    return prev - 2.0 * u[i] + next;
 }
 
-// computes the dispersion in 1D
-// @param populationVec the vector representing the population in 1D
-// @return the dispersed 1D population
-vector<double> computePopulation1DimDispersion(vector<double> populationVec) {
-    const int n = static_cast<int>(populationVec.size());
-    if (n <= 1) return populationVec;
-    vector<double> result(n, 0.0);
+// computes the dispersion in 1D at index i
+// @param populationVec the population along one row or column of a plane
+// @return the dispersion at i
+static inline double computePopulation1DimDispersion(StridedView<const double> populationVec, int i) {
+    const int n = populationVec.size;
+    if (n <= 1) return populationVec[0];
     // Dirichlet-style (as original): at ends, use single neighbor
     // result[i] = u[i-1] - 2u[i] + u[i+1]
-    // left boundary
-    result[0] = -2.0 * populationVec[0] + populationVec[1];
-    for (int i = 1; i < n - 1; ++i) {
-        result[i] = populationVec[i - 1] - 2.0 * populationVec[i] + populationVec[i + 1];
-    }
-    // right boundary
-    result[n - 1] = populationVec[n - 2] - 2.0 * populationVec[n - 1];
-    return result;
+    if (i == 0) return -2.0 * populationVec[0] + populationVec[1];
+    if (i == n - 1) return populationVec[n - 2] - 2.0 * populationVec[n - 1];
+    return populationVec[i - 1] - 2.0 * populationVec[i] + populationVec[i + 1];
 }
 
 // generates the dispersion matrix to perform a 1D dispersion
@@ -318,100 +312,247 @@ vector<double> matrixVectorMultiplication(vector<double> vec, vector<vector<doub
 }
 
 
-// performs simple scalar-product
-// @param animals the vector containing the population of animals at this cell
-// @param coefficients the vector expressing the influence of other populations on our current
-float scalarProduct(vector<double> & animals, vector<double> & coefficients) {
-    double res = 0.0;
-    for (int i = 0; i < animals.size(); i++) {
-        res += animals[i]*coefficients[i];
-    }
-    return static_cast<float>(res);
+// out = in + dt * coef * in over every cell, blocks of cells split over the solver pool
+static void react_parallel(SolverState & state, const Field & in, Field & out, const SimulationConfig & config, double dt) {
+    SDX_PROFILE_SCOPE(PROFILE_REACTION);
+    const std::size_t cells = in.plane_size();
+    const int blocks = static_cast<int>((cells + REACTION_BLOCK - 1) / REACTION_BLOCK);
+    state.pool->parallel_for(0, blocks, [&](int begin, int end, int) {
+        react(in, out, config.coefficients, dt, static_cast<std::size_t>(begin) * REACTION_BLOCK, std::min(cells, static_cast<std::size_t>(end) * REACTION_BLOCK));
+    });
 }
 
-
-// performs the population change on all cells
+// performs the population change on all cells: p += dt * coef * p, evaluated from the old state for every species
+// blocks of cells are split over the solver pool, the result is written to a second buffer that is swapped in
 // @param board is the whole board with populations
-// @param coefficients is how animal at index i is influenced from other population
-void computeChangedPopulation(vector<vector<vector<double>>> & board, vector<vector<double>> & coefficients) {
-    // dp/dt = coef * arr
-    for (int y = 0; y < board.size(); y++) {
-        for (int x = 0; x < board[0].size(); x++) {
-            for (int k = 0; k < board[0][0].size(); k++) {
-                board[y][x][k] += static_cast<double>(scalarProduct(board[y][x], coefficients[k]));
+// @param config supplies the coefficients (how animal at index i is influenced from other population), time step and thread count
+void computeChangedPopulation(Field & board, const SimulationConfig & config) {
+    SolverState & state = solver_state(config.threads);
+    reshape(state.reacted, board);
+    react_parallel(state, board, state.reacted, config, config.delta_time);
+    // the reacted populations become the board, the old buffer is reused by the next step
+    std::swap(board, state.reacted);
+}
+
+// fn(k, cell_begin, cell_end, worker) for every plane, over REACTION_BLOCK sized cell ranges split across the pool
+// the loops of the integrators between reaction and diffusion, timed as the integrator phase
+template <typename Fn>
+static void for_each_cell_block(SolverState & state, const Field & like, const Fn & fn) {
+    SDX_PROFILE_SCOPE(PROFILE_INTEGRATOR);
+    const std::size_t cells = like.plane_size();
+    const int blocks = static_cast<int>((cells + REACTION_BLOCK - 1) / REACTION_BLOCK);
+    state.pool->parallel_for(0, blocks, [&](int begin, int end, int worker) {
+        const std::size_t cell_begin = static_cast<std::size_t>(begin) * REACTION_BLOCK;
+        const std::size_t cell_end = std::min(cells, static_cast<std::size_t>(end) * REACTION_BLOCK);
+        for (int k = 0; k < like.species(); ++k) fn(k, cell_begin, cell_end, worker);
+    });
+}
+
+// second-order (Heun) reaction step over dt in place: u + dt A u + dt^2/2 A^2 u
+static void reactHeun(Field & u, const SimulationConfig & config, double dt) {
+    SolverState & state = solver_state(config.threads);
+    reshape(state.reacted, u);
+    reshape(state.stage, u);
+    react_parallel(state, u, state.reacted, config, dt);
+    react_parallel(state, state.reacted, state.stage, config, dt);
+    for_each_cell_block(state, u, [&](int k, std::size_t begin, std::size_t end, int) {
+        double* out = u.plane(k);
+        const double* second = state.stage.plane(k);
+        for (std::size_t c = begin; c < end; ++c) out[c] = 0.5 * (out[c] + second[c]);
+    });
+}
+
+// implicit diffusion over `a` in place: u <- base + X with (I - a D T_x)(I - a D T_y) X = u - base + a D T base
+// factorizing the correction to `base` instead of the state keeps the splitting error at a^2 T_x T_y X = O(a^3) when base is close to the solution
+// uses the row and column sweeps of the ADI half-steps
+static void solveImplicitDiffusion(Field & u, const Field & base, const SimulationConfig & config, double a, SolverState & state) {
+    const int S = u.species();
+    const int H = u.height();
+    const int W = u.width();
+    if (S == 0 || H == 0 || W == 0) return;
+    // adaptive steps change `a` nearly every step, a cache keyed by r would only fill up
+    state.implicit_rows.resize(S);
+    state.implicit_cols.resize(S);
+    for (int k = 0; k < S; ++k) {
+        const double r = config.dispersion[k] * a;
+        factorize_tridiagonal(W, r, config.boundary, state.implicit_rows[k]);
+        factorize_tridiagonal(H, r, config.boundary, state.implicit_cols[k]);
+    }
+    const int row_blocks = (H + ADI_ROW_BLOCK - 1) / ADI_ROW_BLOCK;
+    {
+        SDX_PROFILE_SCOPE(PROFILE_ADI_ROWS);
+        state.pool->parallel_for(0, S * row_blocks, [&](int begin, int end, int worker) {
+            Workspace & ws = state.workspaces[worker];
+            ws.block.resize(static_cast<std::size_t>(W) * ADI_ROW_BLOCK);
+            ws.zeros.resize(W, 0.0);
+            for (int item = begin; item < end; ++item) {
+                const int k = item / row_blocks;
+                const int y0 = (item % row_blocks) * ADI_ROW_BLOCK;
+                const double r = config.dispersion[k] * a;
+                // (I - r T_x) X* = u - base + r (T_x + T_y) base, in place
+                sweepRowBlock(u.plane(k), base.plane(k), -1.0, r, r, u.plane(k), H, W, y0, std::min(ADI_ROW_BLOCK, H - y0), state.implicit_rows[k], config.boundary, ws);
             }
-        }
+        });
+    }
+    const int column_blocks = (W + ADI_COLUMN_BLOCK - 1) / ADI_COLUMN_BLOCK;
+    {
+        SDX_PROFILE_SCOPE(PROFILE_ADI_COLUMNS);
+        state.pool->parallel_for(0, S * column_blocks, [&](int begin, int end, int) {
+            for (int item = begin; item < end; ++item) {
+                const int k = item / column_blocks;
+                const int x0 = (item % column_blocks) * ADI_COLUMN_BLOCK;
+                // (I - r T_y) X = X*, then u = base + X
+                sweepColumnBlock(nullptr, 0.0, base.plane(k), 1.0, u.plane(k), H, W, x0, std::min(ADI_COLUMN_BLOCK, W - x0), state.implicit_cols[k], config.boundary);
+            }
+        });
     }
 }
 
-// convert [y][x][k] to [k][y][x]
-void add_to_steps() {
-    vector<vector<vector<double>>> res = vector(species.size(), vector<vector<double>>(board.size(), vector<double>(board[0].size(),0.0)));
-    for (int y = 0; y < board.size(); y++) {
-        for (int x = 0; x < board[0].size(); x++) {
-            for (int k = 0; k < species.size(); k++) {
-                res[k][y][x] = board[y][x][k];
-            }
+// ARS(2,2,2), Ascher, Ruuth and Spiteri 1997: L-stable implicit part, stiffly accurate
+static const double IMEX_GAMMA = 1.0 - 1.0 / std::sqrt(2.0);
+static const double IMEX_DELTA = 1.0 - 1.0 / (2.0 * IMEX_GAMMA);
+
+// one IMEX step of length h in place, with R the reaction and L the diffusion operator:
+//   (I - g h L) U2 = u + g h R(u)
+//   (I - g h L) u' = u + h (d R(u) + (1 - d) R(U2)) + h (1 - g) L(U2)
+// R(u) and L(U2) are recovered from the stage equation instead of being evaluated again
+// the embedded first-order solution is u + h R(u) + h L(U2) = u + (U2 - u) / g
+// @return max |u' - embedded| / (1 + max(|u'|, |u|)) if `estimate` is set, else 0
+static double imexStep(Field & u, const SimulationConfig & config, double h, bool estimate) {
+    SolverState & state = solver_state(config.threads);
+    reshape(state.start, u);
+    reshape(state.stage, u);
+    reshape(state.stage_rhs, u);
+    reshape(state.reacted, u);
+    {
+        SDX_PROFILE_SCOPE(PROFILE_INTEGRATOR);
+        state.start.copy_from(u.view());
+    }
+    const double g = IMEX_GAMMA;
+    const double d = IMEX_DELTA;
+
+    react_parallel(state, state.start, state.stage_rhs, config, g * h);
+    {
+        SDX_PROFILE_SCOPE(PROFILE_INTEGRATOR);
+        state.stage.copy_from(state.stage_rhs.view());
+    }
+    solveImplicitDiffusion(state.stage, state.start, config, g * h, state);
+    // U2 + h R(U2)
+    react_parallel(state, state.stage, state.reacted, config, h);
+    for_each_cell_block(state, u, [&](int k, std::size_t begin, std::size_t end, int) {
+        const double* un = state.start.plane(k);
+        const double* rhs2 = state.stage_rhs.plane(k);
+        const double* u2 = state.stage.plane(k);
+        const double* reacted2 = state.reacted.plane(k);
+        double* rhs3 = u.plane(k);
+        for (std::size_t c = begin; c < end; ++c) {
+            rhs3[c] = un[c] + d / g * (rhs2[c] - un[c]) + (1.0 - d) * (reacted2[c] - u2[c]) + (1.0 - g) / g * (u2[c] - rhs2[c]);
         }
+    });
+    solveImplicitDiffusion(u, state.start, config, g * h, state);
+
+    double error = 0.0;
+    if (estimate) {
+        std::fill(state.errors.begin(), state.errors.end(), 0.0);
+        for_each_cell_block(state, u, [&](int k, std::size_t begin, std::size_t end, int worker) {
+            const double* un = state.start.plane(k);
+            const double* u2 = state.stage.plane(k);
+            const double* next = u.plane(k);
+            double e = state.errors[worker];
+            for (std::size_t c = begin; c < end; ++c) {
+                const double embedded = un[c] + (u2[c] - un[c]) / g;
+                e = std::max(e, std::abs(next[c] - embedded) / (1.0 + std::max(std::abs(next[c]), std::abs(un[c]))));
+            }
+            state.errors[worker] = e;
+        });
+        error = *std::max_element(state.errors.begin(), state.errors.end());
     }
-    steps.push_back(res);
+    // populations stay non-negative, as after every diffusion step
+    for_each_cell_block(state, u, [&](int k, std::size_t begin, std::size_t end, int) {
+        double* out = u.plane(k);
+        for (std::size_t c = begin; c < end; ++c) out[c] = std::max(out[c], 0.0);
+    });
+    return error;
 }
 
-void prepareCalculations() {
-    // baseline run according to current method
-    steps.clear();
-    add_to_steps();
-    for (int i = 0; i < number_steps_t; i++) {
-        computeChangedPopulation(board, coefficients);
-        computePopulationsDispersion(board, dispersion_coefficients);
-        add_to_steps();
+// one fixed step of config.delta_time with config.integrator
+static void advance(Field & field, const SimulationConfig & config) {
+    switch (config.integrator) {
+        case INTEGRATOR_STRANG:
+            reactHeun(field, config, 0.5 * config.delta_time);
+            computePopulationsDispersion(field, config);
+            reactHeun(field, config, 0.5 * config.delta_time);
+            break;
+        case INTEGRATOR_IMEX:
+            imexStep(field, config, config.delta_time, false);
+            break;
+        default:
+            computeChangedPopulation(field, config);
+            computePopulationsDispersion(field, config);
+            break;
     }
+}
 
-    if (compare_methods) {
-        // clone initial board
-        auto board0 = steps[0]; // [k][y][x]
-        // explicit
-        steps_explicit.clear();
-        steps_explicit.push_back(board0);
-        // reconstruct board as [y][x][k]
-        vector<vector<vector<double>>> board_exp(board_height, vector<vector<double>>(board_width, vector<double>(species.size(), 0.0)));
-        for (int y = 0; y < board_height; ++y) {
-            for (int x = 0; x < board_width; ++x) {
-                for (int k = 0; k < species.size(); ++k) {
-                    board_exp[y][x][k] = board0[k][y][x];
-                }
-            }
-        }
-        auto saved_method = diffusion_method;
-        diffusion_method = DIFFUSION_EXPLICIT;
-        for (int t = 0; t < number_steps_t; ++t) {
-            computeChangedPopulation(board_exp, coefficients);
-            computePopulationsDispersion(board_exp, dispersion_coefficients);
-            // push [k][y][x]
-            vector<vector<vector<double>>> res(species.size(), vector<vector<double>>(board_height, vector<double>(board_width, 0.0)));
-            for (int y = 0; y < board_height; ++y)
-                for (int x = 0; x < board_width; ++x)
-                    for (int k = 0; k < species.size(); ++k)
-                        res[k][y][x] = board_exp[y][x][k];
-            steps_explicit.push_back(std::move(res));
-        }
+// hands a state to the caller, timed as the record phase
+static bool record_step(const std::function<bool(int, const Field &)> & on_step, int t, const Field & field) {
+    SDX_PROFILE_SCOPE(PROFILE_RECORD);
+    return on_step(t, field);
+}
+
+static void count_step(IntegrationStats & stats, double h) {
+    stats.min_step = stats.accepted ? std::min(stats.min_step, h) : h;
+    stats.max_step = stats.accepted ? std::max(stats.max_step, h) : h;
+    stats.accepted++;
+}
 
-        // ADI
-        steps_adi.clear();
-        steps_adi.push_back(board0);
-        vector<vector<vector<double>>> board_adi = board_exp; // start from same initial
-        diffusion_method = DIFFUSION_ADI;
-        for (int t = 0; t < number_steps_t; ++t) {
-            computeChangedPopulation(board_adi, coefficients);
-            computePopulationsDispersion(board_adi, dispersion_coefficients);
-            vector<vector<vector<double>>> res(species.size(), vector<vector<double>>(board_height, vector<double>(board_width, 0.0)));
-            for (int y = 0; y < board_height; ++y)
-                for (int x = 0; x < board_width; ++x)
-                    for (int k = 0; k < species.size(); ++k)
-                        res[k][y][x] = board_adi[y][x][k];
-            steps_adi.push_back(std::move(res));
+// error controlled IMEX steps, every output interval delta_time ends exactly on an output time
+static bool runAdaptive(Field & field, const SimulationConfig & config, const std::function<bool(int, const Field &)> & on_step, IntegrationStats & stats) {
+    SolverState & state = solver_state(config.threads);
+    const double min_step = config.delta_time * 1e-9;
+    double h = config.delta_time;
+    for (int t = 1; t <= config.steps; ++t) {
+        double remaining = config.delta_time;
+        while (remaining > 0.0) {
+            // the last step of the interval is shortened to land on the output time
+            const bool last = h >= remaining * (1.0 - 1e-12);
+            const double step = last ? remaining : h;
+            const double error = imexStep(field, config, step, true) / config.tolerance;
+            // second-order step with first-order estimate: the error scales with step^2
+            const double factor = error > 0.0 ? 0.9 / std::sqrt(error) : 5.0;
+            if (error <= 1.0 || step <= min_step) {
+                count_step(stats, step);
+                remaining = last ? 0.0 : remaining - step;
+                const double proposed = step * std::min(5.0, std::max(0.2, factor));
+                // a shortened last step says little about the step size that works
+                h = (last && step < h) ? std::max(h, proposed) : proposed;
+            } else {
+                stats.rejected++;
+                SDX_PROFILE_SCOPE(PROFILE_INTEGRATOR);
+                field.copy_from(state.start.view());
+                h = step * std::max(0.2, factor);
+            }
         }
-        diffusion_method = saved_method;
+        if (!record_step(on_step, t, field)) return false;
     }
+    return true;
 }
 
+bool runSimulation(const SimulationConfig & config, const std::function<bool(int, const Field &)> & on_step, IntegrationStats * stats) {
+    IntegrationStats local;
+    IntegrationStats & counts = stats ? *stats : local;
+    counts = IntegrationStats{};
+    std::string error;
+    if (!validate_config(config, error)) {
+        std::cerr << "Invalid configuration: " << error << std::endl;
+        return false;
+    }
+    Field field = config.initial;
+    if (!record_step(on_step, 0, field)) return false;
+    if (config.adaptive && config.integrator == INTEGRATOR_IMEX) return runAdaptive(field, config, on_step, counts);
+    for (int t = 1; t <= config.steps; ++t) {
+        advance(field, config);
+        count_step(counts, config.delta_time);
+        if (!record_step(on_step, t, field)) return false;
+    }
+    return true;
+}
@@ -1,10 +1,27 @@
 #ifndef NUMERICAL_H
 #define NUMERICAL_H
 
+#include <functional>
 #include <vector>
+#include "./Field.h"
+#include "./SimConfig.h"
 
-void computeChangedPopulation(std::vector<std::vector<std::vector<double>>> & board, std::vector<std::vector<double>> & coefficients);
-void computePopulationsDispersion(std::vector<std::vector<std::vector<double>>> & populations, std::vector<double> dispersionCoefficients);
-void prepareCalculations();
+// both operators split their work over a persistent pool of config.threads workers
+// the pool and scratch buffers are shared, so only one thread may run the solver at a time
+void computeChangedPopulation(Field & board, const SimulationConfig & config);
+void computePopulationsDispersion(Field & populations, const SimulationConfig & config);
+// internal steps of a run, with adaptive stepping they differ from config.steps
+struct IntegrationStats {
+    int accepted = 0;
+    int rejected = 0;
+    double min_step = 0.0;
+    double max_step = 0.0;
+};
 
-#endif // NUMERICAL_H
\ No newline at end of file
+// runs config.steps steps of config.integrator starting from config.initial
+// on_step(t, state) is called with the initial state (t = 0) and at every time t * delta_time, returning false stops the run
+// @param stats if given, receives the internal step counts
+// @return true if every step ran, false if on_step stopped the run or config fails validate_config (reported on std::cerr)
+bool runSimulation(const SimulationConfig & config, const std::function<bool(int, const Field &)> & on_step, IntegrationStats * stats = nullptr);
+
+#endif // NUMERICAL_H
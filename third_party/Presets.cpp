@@ -1,5 +1,5 @@
 #include "Presets.h"
-#include "settings.h"
+#include "Species.h"
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
@@ -15,49 +15,32 @@ struct PresetDef {
     DiffusionMethod method;
     double dt;
     int steps;
-    std::function<void()> init_board;   // fills global board
+    std::function<void(Field&)> init_board; // fills the initial board
 };
 
 static std::vector<PresetDef> g_presets;
 static std::vector<std::string> g_names;
 
-static void set_species(const std::vector<std::string>& names, const std::vector<uint32_t>& cols) {
-    species.clear();
-    for (int i = 0; i < (int)names.size(); ++i) {
-        species.emplace_back(names[i], cols[i % (int)cols.size()]);
-        species.back().color = cols[i % (int)cols.size()];
-    }
-}
-
-static void set_coefficients(const std::vector<std::vector<double>>& A) {
-    const int s = (int)A.size();
-    coefficients.assign(15, std::vector<double>(15, 0.0));
-    for (int i = 0; i < s; ++i) for (int j = 0; j < s; ++j) coefficients[i][j] = A[i][j];
-}
-
-static void set_dispersion(const std::vector<double>& Dvec) {
-    dispersion_coefficients.assign(15, 0.0);
-    for (int i = 0; i < (int)Dvec.size(); ++i) dispersion_coefficients[i] = Dvec[i];
-}
-
-static void seed_gaussian(int cx, int cy, double amp, double sigma, int k) {
-    for (int y = 0; y < board_height; ++y) {
-        for (int x = 0; x < board_width; ++x) {
+static void seed_gaussian(Field& board, int cx, int cy, double amp, double sigma, int k) {
+    for (int y = 0; y < board.height(); ++y) {
+        for (int x = 0; x < board.width(); ++x) {
             double dx = x - cx;
             double dy = y - cy;
-            board[y][x][k] += amp * std::exp(-(dx*dx + dy*dy) / (2.0 * sigma * sigma));
+            board(k,y,x) += amp * std::exp(-(dx*dx + dy*dy) / (2.0 * sigma * sigma));
         }
     }
 }
 
-static void seed_gaussian_frac(double fx, double fy, double amp, double sigma_frac, int k) {
+void seed_gaussian_frac(Field& board, double fx, double fy, double amp, double sigma_frac, int k) {
+    const int board_width = board.width(), board_height = board.height();
     int cx = std::clamp((int)std::round(fx * (board_width - 1)), 0, board_width - 1);
     int cy = std::clamp((int)std::round(fy * (board_height - 1)), 0, board_height - 1);
     double sigma = sigma_frac * std::max(1, std::min(board_width, board_height));
-    seed_gaussian(cx, cy, amp, sigma, k);
+    seed_gaussian(board, cx, cy, amp, sigma, k);
 }
 
-static void seed_ring_frac(double fx, double fy, double r_inner_frac, double r_outer_frac, double val, int k) {
+void seed_ring_frac(Field& board, double fx, double fy, double r_inner_frac, double r_outer_frac, double val, int k) {
+    const int board_width = board.width(), board_height = board.height();
     int cx = std::clamp((int)std::round(fx * (board_width - 1)), 0, board_width - 1);
     int cy = std::clamp((int)std::round(fy * (board_height - 1)), 0, board_height - 1);
     double scale = std::max(1, std::min(board_width, board_height));
@@ -66,7 +49,7 @@ static void seed_ring_frac(double fx, double fy, double r_inner_frac, double r_o
     for (int y=0;y<board_height;++y) {
         for (int x=0;x<board_width;++x) {
             double dx=x-cx, dy=y-cy; double d2 = dx*dx+dy*dy;
-            if (d2 >= r1*r1 && d2 <= r2*r2) board[y][x][k] = val;
+            if (d2 >= r1*r1 && d2 <= r2*r2) board(k,y,x) = val;
         }
     }
 }
@@ -87,11 +70,12 @@ void init_presets() {
         DIFFUSION_EXPLICIT,
         0.8,
         200,
-        [](){
+        [](Field& board){
+            const int board_width = board.width(), board_height = board.height();
             int w = std::max(1, (int)std::round(0.08 * board_width));
             for (int y=0;y<board_height;++y) {
-                for (int x=0;x<w; ++x) board[y][x][0]=50.0;
-                for (int x=board_width-w; x<board_width; ++x) if (x>=0) board[y][x][0]=50.0;
+                for (int x=0;x<w; ++x) board(0,y,x)=50.0;
+                for (int x=board_width-w; x<board_width; ++x) if (x>=0) board(0,y,x)=50.0;
             }
         }
     });
@@ -107,9 +91,9 @@ void init_presets() {
         DIFFUSION_ADI,
         1.0,
         220,
-        [](){
-            seed_ring_frac(0.5,0.5, 0.16, 0.24, 100.0, 0); // prey ring mass
-            seed_gaussian_frac(0.5,0.5, 150.0, 0.05, 1);   // predator core mass
+        [](Field& board){
+            seed_ring_frac(board, 0.5,0.5, 0.16, 0.24, 100.0, 0); // prey ring mass
+            seed_gaussian_frac(board, 0.5,0.5, 150.0, 0.05, 1);   // predator core mass
         }
     });
 
@@ -124,10 +108,10 @@ void init_presets() {
         DIFFUSION_ADI,
         1.0,
         240,
-        [](){
-            seed_gaussian_frac(0.20,0.20, 120.0, 0.05, 0);
-            seed_gaussian_frac(0.80,0.25, 120.0, 0.05, 1);
-            seed_gaussian_frac(0.50,0.80, 120.0, 0.05, 2);
+        [](Field& board){
+            seed_gaussian_frac(board, 0.20,0.20, 120.0, 0.05, 0);
+            seed_gaussian_frac(board, 0.80,0.25, 120.0, 0.05, 1);
+            seed_gaussian_frac(board, 0.50,0.80, 120.0, 0.05, 2);
         }
     });
 
@@ -142,10 +126,11 @@ void init_presets() {
         DIFFUSION_EXPLICIT,
         0.7,
         300,
-        [](){
+        [](Field& board){
+            const int board_width = board.width(), board_height = board.height();
             for (int y=0;y<board_height;++y) for (int x=0;x<board_width;++x) {
-                board[y][x][0] = (rand()%1000)/33.0; // ~0..30
-                board[y][x][1] = (rand()%1000)/33.0;
+                board(0,y,x) = (rand()%1000)/33.0; // ~0..30
+                board(1,y,x) = (rand()%1000)/33.0;
             }
         }
     });
@@ -161,12 +146,13 @@ void init_presets() {
         DIFFUSION_EXPLICIT,
         0.6,
         180,
-        [](){
+        [](Field& board){
+            const int board_width = board.width(), board_height = board.height();
             int m = std::max(2, std::min(board_width, board_height)/10);
-            for (int y=0;y<m;++y) for (int x=0;x<m;++x) board[y][x][0]=200.0;
-            for (int y=board_height-m;y<board_height;++y) for (int x=0;x<m;++x) board[y][x][1]=200.0;
-            for (int y=0;y<m;++y) for (int x=board_width-m;x<board_width;++x) board[y][x][2]=200.0;
-            for (int y=board_height-m;y<board_height;++y) for (int x=board_width-m;x<board_width;++x) board[y][x][3]=200.0;
+            for (int y=0;y<m;++y) for (int x=0;x<m;++x) board(0,y,x)=200.0;
+            for (int y=board_height-m;y<board_height;++y) for (int x=0;x<m;++x) board(1,y,x)=200.0;
+            for (int y=0;y<m;++y) for (int x=board_width-m;x<board_width;++x) board(2,y,x)=200.0;
+            for (int y=board_height-m;y<board_height;++y) for (int x=board_width-m;x<board_width;++x) board(3,y,x)=200.0;
         }
     });
 
@@ -181,7 +167,7 @@ void init_presets() {
         DIFFUSION_ADI,
         1.0,
         200,
-        [](){ seed_gaussian_frac(0.5, 0.5, 200.0, 0.10, 0); seed_gaussian_frac(0.5, 0.5, 200.0, 0.10, 1);} 
+        [](Field& board){ seed_gaussian_frac(board, 0.5, 0.5, 200.0, 0.10, 0); seed_gaussian_frac(board, 0.5, 0.5, 200.0, 0.10, 1);}
     });
 
     g_names.clear();
@@ -190,19 +176,34 @@ void init_presets() {
 
 const std::vector<std::string>& get_preset_names() { return g_names; }
 
-void apply_preset(int index) {
-    if (index < 0 || index >= (int)g_presets.size()) return;
-    const auto& p = g_presets[index];
-    set_species(p.species_names, p.species_colors);
-    set_coefficients(p.A);
-    set_dispersion(p.D);
-    boundary_condition = p.bc;
-    diffusion_method = p.method;
-    delta_time = p.dt;
-    number_steps_t = p.steps;
-    // initialize board
-    for (int y=0;y<board_height;++y) for (int x=0;x<board_width;++x) for (int k=0;k<(int)p.species_names.size();++k) board[y][x][k]=0.0;
-    p.init_board();
+int find_preset(const std::string& name) {
+    init_presets();
+    for (int i = 0; i < (int)g_names.size(); ++i) if (g_names[i] == name) return i;
+    return -1;
 }
 
+const std::vector<uint32_t>& get_preset_colors(int index) {
+    static const std::vector<uint32_t> none;
+    if (index < 0 || index >= (int)g_presets.size()) return none;
+    return g_presets[index].species_colors;
+}
 
+bool build_preset(int index, int width, int height, SimulationConfig& config) {
+    init_presets();
+    if (index < 0 || index >= (int)g_presets.size()) return false;
+    const auto& p = g_presets[index];
+    const int s = (int)p.species_names.size();
+    config.width = width;
+    config.height = height;
+    config.species_names = p.species_names;
+    config.coefficients = p.A;
+    config.dispersion = p.D;
+    config.boundary = p.bc;
+    config.method = p.method;
+    config.delta_time = p.dt;
+    config.steps = p.steps;
+    // initialize board
+    config.initial.reset(s, height, width);
+    p.init_board(config.initial);
+    return true;
+}
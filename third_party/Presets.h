@@ -1,14 +1,26 @@
 #ifndef PRESETS_H
 #define PRESETS_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <functional>
+#include "./Field.h"
+#include "./SimConfig.h"
 
 // Forward declarations
 void init_presets();
 const std::vector<std::string>& get_preset_names();
-void apply_preset(int index);
+// index of the preset called `name`, -1 if there is none
+int find_preset(const std::string& name);
+// display colors of the species of preset `index`
+const std::vector<uint32_t>& get_preset_colors(int index);
+// fills `config` with preset `index` on a width x height board
+// @return false if there is no such preset
+bool build_preset(int index, int width, int height, SimulationConfig& config);
 
-#endif // PRESETS_H
+// seeding helpers, positions and radii are fractions of the board size
+void seed_gaussian_frac(Field& field, double fx, double fy, double amp, double sigma_frac, int k);
+void seed_ring_frac(Field& field, double fx, double fy, double r_inner_frac, double r_outer_frac, double val, int k);
 
+#endif // PRESETS_H
@@ -0,0 +1,40 @@
+#include "Profiler.h"
+#include <atomic>
+
+// scopes close on the solver thread while the GUI reads the totals, relaxed counters are enough
+static std::atomic<uint64_t> phase_nanoseconds[PROFILE_PHASE_COUNT];
+static std::atomic<uint64_t> phase_calls[PROFILE_PHASE_COUNT];
+
+const char* profile_phase_name(ProfilePhase phase) {
+    switch (phase) {
+        case PROFILE_REACTION: return "reaction";
+        case PROFILE_DIFFUSION_EXPLICIT: return "explicit diffusion";
+        case PROFILE_ADI_ROWS: return "ADI rows";
+        case PROFILE_ADI_COLUMNS: return "ADI columns";
+        case PROFILE_DIFFUSION_APPLY: return "apply diffusion";
+        case PROFILE_INTEGRATOR: return "integrator";
+        case PROFILE_RECORD: return "record";
+        default: return "?";
+    }
+}
+
+void profile_reset() {
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+        phase_nanoseconds[p].store(0, std::memory_order_relaxed);
+        phase_calls[p].store(0, std::memory_order_relaxed);
+    }
+}
+
+void profile_add(ProfilePhase phase, uint64_t nanoseconds) {
+    phase_nanoseconds[phase].fetch_add(nanoseconds, std::memory_order_relaxed);
+    phase_calls[phase].fetch_add(1, std::memory_order_relaxed);
+}
+
+ProfileTotals profile_snapshot() {
+    ProfileTotals totals;
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+        totals.nanoseconds[p] = phase_nanoseconds[p].load(std::memory_order_relaxed);
+        totals.calls[p] = phase_calls[p].load(std::memory_order_relaxed);
+    }
+    return totals;
+}
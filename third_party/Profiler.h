@@ -0,0 +1,61 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+
+// hot-path phases timed by SDX_PROFILE_SCOPE
+enum ProfilePhase {
+    PROFILE_REACTION,
+    PROFILE_DIFFUSION_EXPLICIT,
+    PROFILE_ADI_ROWS,
+    PROFILE_ADI_COLUMNS,
+    PROFILE_DIFFUSION_APPLY,
+    PROFILE_INTEGRATOR,
+    PROFILE_RECORD,
+    PROFILE_PHASE_COUNT
+};
+
+// accumulated time and number of scopes per phase since the last profile_reset()
+struct ProfileTotals {
+    uint64_t nanoseconds[PROFILE_PHASE_COUNT] = {};
+    uint64_t calls[PROFILE_PHASE_COUNT] = {};
+};
+
+const char* profile_phase_name(ProfilePhase phase);
+void profile_reset();
+void profile_add(ProfilePhase phase, uint64_t nanoseconds);
+// may be taken while a run is in progress
+ProfileTotals profile_snapshot();
+
+#ifdef SIMDYNAMIX_PROFILE
+
+inline constexpr bool profile_enabled = true;
+
+// adds the lifetime of the scope to `phase`
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfilePhase phase) : phase_(phase), start_(std::chrono::steady_clock::now()) {}
+    ~ProfileScope() {
+        profile_add(phase_, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfilePhase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define SDX_PROFILE_CONCAT_(a, b) a##b
+#define SDX_PROFILE_CONCAT(a, b) SDX_PROFILE_CONCAT_(a, b)
+#define SDX_PROFILE_SCOPE(phase) ProfileScope SDX_PROFILE_CONCAT(sdx_profile_scope_, __LINE__)(phase)
+
+#else
+
+inline constexpr bool profile_enabled = false;
+#define SDX_PROFILE_SCOPE(phase) ((void)0)
+
+#endif // SIMDYNAMIX_PROFILE
+
+#endif // PROFILER_H
@@ -0,0 +1,64 @@
+#include "Reaction.h"
+#include <algorithm>
+
+// one block of cells for every species, the inner loop runs over contiguous cells and vectorizes
+// with N known at compile time the species loop is unrolled and A stays in registers
+template <int N>
+static void react_fixed(const double* __restrict in, double* __restrict out, std::size_t plane_stride, const double* __restrict A, std::size_t begin, std::size_t end) {
+    for (std::size_t i0 = begin; i0 < end; i0 += REACTION_BLOCK) {
+        const std::size_t i1 = std::min(end, i0 + REACTION_BLOCK);
+        for (int k = 0; k < N; ++k) {
+            const double* __restrict self = in + k * plane_stride;
+            double* __restrict dst = out + k * plane_stride;
+            for (std::size_t i = i0; i < i1; ++i) {
+                double acc = 0.0;
+                for (int j = 0; j < N; ++j) acc += A[k * N + j] * in[j * plane_stride + i];
+                dst[i] = self[i] + acc;
+            }
+        }
+    }
+}
+
+// same product for any number of species
+static void react_generic(int n, const double* __restrict in, double* __restrict out, std::size_t plane_stride, const double* __restrict A, std::size_t begin, std::size_t end) {
+    for (std::size_t i0 = begin; i0 < end; i0 += REACTION_BLOCK) {
+        const std::size_t i1 = std::min(end, i0 + REACTION_BLOCK);
+        for (int k = 0; k < n; ++k) {
+            double* __restrict dst = out + k * plane_stride;
+            const double* __restrict self = in + k * plane_stride;
+            for (std::size_t i = i0; i < i1; ++i) dst[i] = self[i];
+            for (int j = 0; j < n; ++j) {
+                const double a = A[k * n + j];
+                if (a == 0.0) continue;
+                const double* __restrict src = in + j * plane_stride;
+                for (std::size_t i = i0; i < i1; ++i) dst[i] += a * src[i];
+            }
+        }
+    }
+}
+
+void react(const Field& in, Field& out, const std::vector<std::vector<double>>& coefficients, double dt, std::size_t cell_begin, std::size_t cell_end) {
+    const int n = in.species();
+    if (n == 0 || cell_begin >= cell_end) return;
+    // dt * A, row-major [affected][source]
+    double A[SPECIES_MATRIX_MAX];
+    std::vector<double> A_large;
+    double* scaled = A;
+    if (n * n > SPECIES_MATRIX_MAX) {
+        A_large.resize(static_cast<std::size_t>(n) * n);
+        scaled = A_large.data();
+    }
+    for (int k = 0; k < n; ++k) {
+        for (int j = 0; j < n; ++j) scaled[k * n + j] = dt * coefficients[k][j];
+    }
+
+    const std::size_t ps = in.plane_stride();
+    switch (n) {
+        case 1: react_fixed<1>(in.data(), out.data(), ps, scaled, cell_begin, cell_end); break;
+        case 2: react_fixed<2>(in.data(), out.data(), ps, scaled, cell_begin, cell_end); break;
+        case 3: react_fixed<3>(in.data(), out.data(), ps, scaled, cell_begin, cell_end); break;
+        case 4: react_fixed<4>(in.data(), out.data(), ps, scaled, cell_begin, cell_end); break;
+        case 5: react_fixed<5>(in.data(), out.data(), ps, scaled, cell_begin, cell_end); break;
+        default: react_generic(n, in.data(), out.data(), ps, scaled, cell_begin, cell_end); break;
+    }
+}
@@ -0,0 +1,19 @@
+#ifndef REACTION_H
+#define REACTION_H
+
+#include <cstddef>
+#include <vector>
+#include "./Field.h"
+
+// cells per block of the reaction kernel, SPECIES_LIMIT planes of a block stay in L1
+#define REACTION_BLOCK 256
+// coefficient matrices up to this many entries (15 species) are scaled on the stack
+#define SPECIES_MATRIX_MAX (15 * 15)
+
+// reaction step as one batched product over the whole grid: out = in + dt * A * in,
+// with A the (species x species) coefficient matrix and in/out viewed as (species x cells) matrices
+// in and out must be different fields of the same shape, only cells [cell_begin, cell_end) of every plane are written
+// species counts 1 to 5 use kernels specialised at compile time, larger counts a generic one
+void react(const Field& in, Field& out, const std::vector<std::vector<double>>& coefficients, double dt, std::size_t cell_begin, std::size_t cell_end);
+
+#endif // REACTION_H
@@ -0,0 +1,194 @@
+#include "SimConfig.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "./Presets.h"
+#include "./ThreadPool.h"
+
+void resize_config(SimulationConfig& config, int species, int height, int width) {
+    const int old_species = config.species();
+    config.species_names.resize(species);
+    for (int k = old_species; k < species; k++) config.species_names[k] = "species " + std::to_string(k + 1);
+    config.coefficients.resize(species);
+    for (auto& row : config.coefficients) row.resize(species, 0.0);
+    config.dispersion.resize(species, 0.1);
+    config.height = height;
+    config.width = width;
+    config.initial.resize(species, height, width);
+}
+
+bool validate_config(const SimulationConfig& config, std::string& error) {
+    const int s = config.species();
+    if (s < 1) { error = "no species configured"; return false; }
+    if (config.width < 1 || config.height < 1) { error = "board size must be at least 1x1"; return false; }
+    if ((int)config.coefficients.size() != s) { error = "coefficient matrix must have one row per species"; return false; }
+    for (const auto& row : config.coefficients) {
+        if ((int)row.size() != s) { error = "coefficient matrix must have one column per species"; return false; }
+    }
+    if ((int)config.dispersion.size() != s) { error = "dispersion needs one value per species"; return false; }
+    if (config.initial.species() != s || config.initial.height() != config.height || config.initial.width() != config.width) {
+        error = "initial board does not match species count and board size";
+        return false;
+    }
+    if (!(config.delta_time > 0.0)) { error = "delta t must be positive"; return false; }
+    if (config.steps < 0) { error = "number of steps must not be negative"; return false; }
+    if (config.adaptive && config.integrator != INTEGRATOR_IMEX) { error = "adaptive stepping needs the imex integrator"; return false; }
+    if (config.adaptive && !(config.tolerance > 0.0)) { error = "tolerance must be positive"; return false; }
+    if (config.threads < 0 || config.threads > ThreadPool::max_threads()) {
+        error = "threads must be between 0 (every core) and " + std::to_string(ThreadPool::max_threads());
+        return false;
+    }
+    return true;
+}
+
+const char* diffusion_method_name(DiffusionMethod method) {
+    return method == DIFFUSION_ADI ? "adi" : "explicit";
+}
+
+const char* boundary_condition_name(BoundaryCondition bc) {
+    return bc == BC_NEUMANN ? "neumann" : "dirichlet";
+}
+
+const char* integrator_name(Integrator integrator) {
+    switch (integrator) {
+        case INTEGRATOR_STRANG: return "strang";
+        case INTEGRATOR_IMEX: return "imex";
+        default: return "lie";
+    }
+}
+
+bool parse_integrator(const std::string& name, Integrator& integrator) {
+    if (name == "lie") integrator = INTEGRATOR_LIE;
+    else if (name == "strang") integrator = INTEGRATOR_STRANG;
+    else if (name == "imex") integrator = INTEGRATOR_IMEX;
+    else return false;
+    return true;
+}
+
+// one `key values...` line per setting, `#` starts a comment, applied top to bottom
+bool load_config_file(const std::string& path, SimulationConfig& config, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string line;
+    int line_no = 0;
+    while (std::getline(in, line)) {
+        line_no++;
+        auto fail = [&](const std::string& msg) {
+            error = path + ":" + std::to_string(line_no) + ": " + msg;
+            return false;
+        };
+        auto hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream ls(line);
+        std::string key;
+        if (!(ls >> key)) continue;
+
+        // species index argument of the seeding keys
+        auto read_species = [&](int& k) {
+            return (ls >> k) && k >= 0 && k < config.species();
+        };
+
+        if (key == "preset") {
+            std::string name;
+            std::getline(ls >> std::ws, name);
+            while (!name.empty() && std::isspace((unsigned char)name.back())) name.pop_back();
+            int index = find_preset(name);
+            if (index < 0 && !name.empty() && name.find_first_not_of("0123456789") == std::string::npos) index = std::atoi(name.c_str());
+            if (!build_preset(index, config.width, config.height, config)) return fail("unknown preset '" + name + "'");
+        } else if (key == "width" || key == "height") {
+            int n = 0;
+            if (!(ls >> n) || n < 1) return fail(key + " needs a positive integer");
+            if (key == "width") resize_config(config, config.species(), config.height, n);
+            else resize_config(config, config.species(), n, config.width);
+        } else if (key == "species") {
+            std::vector<std::string> names;
+            std::string name;
+            while (ls >> name) names.push_back(name);
+            if (names.empty()) return fail("species needs at least one name");
+            resize_config(config, (int)names.size(), config.height, config.width);
+            config.species_names = names;
+        } else if (key == "method") {
+            std::string m;
+            ls >> m;
+            if (m == "explicit") config.method = DIFFUSION_EXPLICIT;
+            else if (m == "adi") config.method = DIFFUSION_ADI;
+            else return fail("method must be explicit or adi");
+        } else if (key == "boundary") {
+            std::string b;
+            ls >> b;
+            if (b == "dirichlet") config.boundary = BC_DIRICHLET;
+            else if (b == "neumann") config.boundary = BC_NEUMANN;
+            else return fail("boundary must be dirichlet or neumann");
+        } else if (key == "integrator") {
+            std::string name;
+            ls >> name;
+            if (!parse_integrator(name, config.integrator)) return fail("integrator must be lie, strang or imex");
+        } else if (key == "adaptive") {
+            double tolerance = 0.0;
+            if (!(ls >> tolerance) || tolerance < 0.0) return fail("adaptive needs a tolerance (0 = fixed steps)");
+            config.adaptive = tolerance > 0.0;
+            if (config.adaptive) config.tolerance = tolerance;
+        } else if (key == "dt") {
+            if (!(ls >> config.delta_time) || !(config.delta_time > 0.0)) return fail("dt needs a positive number");
+        } else if (key == "steps") {
+            if (!(ls >> config.steps) || config.steps < 0) return fail("steps needs a non-negative integer");
+        } else if (key == "threads") {
+            if (!(ls >> config.threads)) return fail("threads needs an integer (0 = every core)");
+        } else if (key == "coefficients") {
+            // full matrix, row-major [affected][source]
+            for (auto& row : config.coefficients) {
+                for (double& v : row) {
+                    if (!(ls >> v)) return fail("coefficients needs species*species values");
+                }
+            }
+        } else if (key == "coefficient") {
+            int i = 0, j = 0;
+            double v = 0.0;
+            if (!(ls >> i >> j >> v) || i < 0 || j < 0 || i >= config.species() || j >= config.species()) return fail("coefficient needs <affected> <source> <value>");
+            config.coefficients[i][j] = v;
+        } else if (key == "dispersion") {
+            for (double& d : config.dispersion) {
+                if (!(ls >> d)) return fail("dispersion needs one value per species");
+            }
+        } else if (key == "clear") {
+            config.initial.fill(0.0);
+        } else if (key == "fill") {
+            int k = 0;
+            double v = 0.0;
+            if (!read_species(k) || !(ls >> v)) return fail("fill needs <species> <value>");
+            std::fill(config.initial.plane(k), config.initial.plane(k) + config.initial.plane_size(), v);
+        } else if (key == "cell") {
+            int k = 0, x = 0, y = 0;
+            double v = 0.0;
+            if (!read_species(k) || !(ls >> x >> y >> v) || x < 0 || y < 0 || x >= config.width || y >= config.height) return fail("cell needs <species> <x> <y> <value>");
+            config.initial(k, y, x) = v;
+        } else if (key == "gaussian") {
+            int k = 0;
+            double fx, fy, amp, sigma;
+            if (!read_species(k) || !(ls >> fx >> fy >> amp >> sigma)) return fail("gaussian needs <species> <fx> <fy> <amplitude> <sigma>");
+            seed_gaussian_frac(config.initial, fx, fy, amp, sigma, k);
+        } else if (key == "ring") {
+            int k = 0;
+            double fx, fy, r_in, r_out, v;
+            if (!read_species(k) || !(ls >> fx >> fy >> r_in >> r_out >> v)) return fail("ring needs <species> <fx> <fy> <inner> <outer> <value>");
+            seed_ring_frac(config.initial, fx, fy, r_in, r_out, v, k);
+        } else if (key == "noise") {
+            int k = 0;
+            double amp = 0.0;
+            unsigned seed = 1;
+            if (!read_species(k) || !(ls >> amp)) return fail("noise needs <species> <amplitude> [seed]");
+            ls >> seed;
+            std::srand(seed);
+            double* plane = config.initial.plane(k);
+            for (std::size_t i = 0; i < config.initial.plane_size(); i++) plane[i] += amp * (std::rand() % 1000) / 1000.0;
+        } else {
+            return fail("unknown key '" + key + "'");
+        }
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+#ifndef SIM_CONFIG_H
+#define SIM_CONFIG_H
+
+#include <string>
+#include <vector>
+#include "./Field.h"
+
+// Diffusion method selection
+enum DiffusionMethod {
+    DIFFUSION_EXPLICIT = 0,
+    DIFFUSION_ADI = 1
+};
+
+// Boundary condition selection
+enum BoundaryCondition {
+    BC_DIRICHLET = 0, // value outside domain is 0
+    BC_NEUMANN = 1    // zero-flux, mirror at boundary
+};
+
+// time integration of reaction and diffusion
+enum Integrator {
+    INTEGRATOR_LIE = 0,    // reaction then diffusion, first order
+    INTEGRATOR_STRANG = 1, // half reaction, diffusion, half reaction; second order with ADI
+    INTEGRATOR_IMEX = 2    // IMEX Runge-Kutta ARS(2,2,2): implicit diffusion, explicit reaction, second order
+};
+
+// everything the solver needs for one run, independent of the GUI state
+struct SimulationConfig {
+    int width = 10;
+    int height = 10;
+    std::vector<std::string> species_names;     // one entry per simulated species
+    std::vector<std::vector<double>> coefficients; // interaction matrix [affected][source], species x species
+    std::vector<double> dispersion;             // dispersion per species
+    DiffusionMethod method = DIFFUSION_EXPLICIT;
+    BoundaryCondition boundary = BC_DIRICHLET;
+    Integrator integrator = INTEGRATOR_LIE;
+    double delta_time = 1.0;                    // time step, with adaptive stepping the output interval
+    int steps = 10;
+    bool adaptive = false;                      // error controlled internal steps (IMEX only)
+    double tolerance = 1e-4;                    // relative/absolute error per internal step when adaptive
+    int threads = 1;                            // solver worker threads, 0 uses every core
+    Field initial;                              // initial populations, species x height x width
+
+    int species() const { return static_cast<int>(species_names.size()); }
+};
+
+// reshapes the config to `species` species on a height x width grid, keeping overlapping values
+void resize_config(SimulationConfig& config, int species, int height, int width);
+
+// checks that all sizes agree and the parameters are usable
+// @return false with a message in `error` if the config cannot be simulated
+bool validate_config(const SimulationConfig& config, std::string& error);
+
+// loads a scenario file on top of `config`, see README "Headless runs" for the format
+// @return false with a message in `error` on the first bad line
+bool load_config_file(const std::string& path, SimulationConfig& config, std::string& error);
+
+const char* diffusion_method_name(DiffusionMethod method);
+const char* boundary_condition_name(BoundaryCondition bc);
+const char* integrator_name(Integrator integrator);
+// @return false if `name` is not lie, strang or imex
+bool parse_integrator(const std::string& name, Integrator& integrator);
+
+#endif // SIM_CONFIG_H
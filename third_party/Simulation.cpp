@@ -1,13 +1,20 @@
 #include "imgui.h"
 #include "implot.h"
 #include "./settings.h"
+#include "./Numerical.h"
+#include "./Simulation.h"
+#include "./HeatmapCache.h"
+#include "./Profiler.h"
 #include "vector"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <thread>
 
-// TODO labels should be generated only once
 // TODO add a text for every graph with the name of species
-// TODO fix by calculation at numerical to prevent reconversion to correct format
 // TODO pop dynamics dp/dt = k*q when p is but 0 should not change
-// TODO optimisation possible through SIMD
 // TODO either let the user input themselves the scaling_max or calculate it similar to median
 using namespace std;
 
@@ -15,11 +22,195 @@ using namespace std;
 int selected_timestep = 1;
 
 
-void generate_labels(vector<std::string>& labels, int count, const char* prefix) {
-    labels.clear();
-    for (int i = 0; i < count; ++i) {
-        labels.push_back(std::string(prefix) + std::to_string(i + 1)); // Label names like "R1", "R2", ...
+SimulationConfig gui_simulation_config() {
+    SimulationConfig config;
+    const int s = static_cast<int>(species.size());
+    config.width = board_width;
+    config.height = board_height;
+    for (const auto& sp : species) config.species_names.push_back(sp.name);
+    config.coefficients.assign(s, vector<double>(s, 0.0));
+    for (int i = 0; i < s; ++i) for (int j = 0; j < s; ++j) config.coefficients[i][j] = coefficients[i][j];
+    config.dispersion.assign(dispersion_coefficients.begin(), dispersion_coefficients.begin() + s);
+    config.method = diffusion_method;
+    config.boundary = boundary_condition;
+    config.integrator = integrator;
+    config.adaptive = adaptive_steps && integrator == INTEGRATOR_IMEX;
+    config.tolerance = step_tolerance;
+    config.delta_time = delta_time;
+    config.steps = number_steps_t;
+    config.threads = solver_threads;
+    config.initial.reset(s, board_height, board_width);
+    config.initial.copy_from(board.view());
+    return config;
+}
+
+// a run on the background worker: the worker owns the writer, the render thread the reader
+struct SimulationJob {
+    SimulationConfig config;
+    TrajectoryWriter writer;
+    TrajectoryReader* frames = nullptr;
+    // records completely on disk, stored by the worker after every record (release) and
+    // loaded by the render thread before it maps them (acquire)
+    std::atomic<std::size_t> published{0};
+};
+
+// the baseline run and the run with the other diffusion method, simulated one after another
+static struct {
+    SimulationJob jobs[2];
+    int job_count = 0;
+    std::thread worker;
+    std::atomic<bool> cancel{false};
+    std::atomic<bool> running{false};
+    std::atomic<bool> failed{false};
+    std::atomic<int> completed{0};  // steps done over all jobs
+    int total = 0;
+    std::chrono::steady_clock::time_point start;
+    double seconds = 0.0;           // duration of the finished run, written before running is cleared
+    std::string error;              // why the last run could not start, shown instead of the progress
+} background;
+
+// creates the trajectory file of a job and maps it for the render thread
+// @return false with the reason in background.error if the configuration is invalid or the file cannot be created
+static bool start_job(const SimulationConfig& config, TrajectoryReader& out, const char* name) {
+    out.close();
+    if (!validate_config(config, background.error)) {
+        background.error = "Invalid configuration: " + background.error;
+        return false;
+    }
+    SimulationJob& job = background.jobs[background.job_count];
+    job.config = config;
+    job.frames = &out;
+    job.published.store(0, std::memory_order_relaxed);
+    // unique per process (random token) and per run (counter), so several windows never share a file
+    static const unsigned token = std::random_device{}();
+    static unsigned counter = 0;
+    const std::string file = "simdynamix_" + std::to_string(token) + "_" + std::to_string(counter++) + "_" + name + ".sdx";
+    const std::string path = (std::filesystem::temp_directory_path() / file).string();
+    TrajectoryOptions options;
+    options.stride = snapshot_stride;
+    // the reader deletes the file once it is closed, by the next run, Stop or on exit
+    const bool ok = job.writer.open(path, config, options, background.error) && out.open(path, background.error, true);
+    if (!ok) {
+        std::cerr << background.error << std::endl;
+        job.writer.close();
+        std::remove(path.c_str());
+        return false;
     }
+    background.job_count++;
+    return true;
+}
+
+// closes and deletes the files of the jobs started so far, used when a later job cannot start
+static void discard_jobs() {
+    for (int j = 0; j < background.job_count; ++j) {
+        background.jobs[j].writer.close();
+        background.jobs[j].frames->close();
+    }
+    background.job_count = 0;
+}
+
+static void run_jobs() {
+    for (int j = 0; j < background.job_count && !background.cancel.load(std::memory_order_relaxed); ++j) {
+        SimulationJob& job = background.jobs[j];
+        runSimulation(job.config, [&job](int t, const Field& state) {
+            if (!job.writer.write(t, state)) {
+                background.failed.store(true, std::memory_order_relaxed);
+                return false;
+            }
+            job.published.store(job.writer.frames(), std::memory_order_release);
+            if (t > 0) background.completed.fetch_add(1, std::memory_order_relaxed);
+            return !background.cancel.load(std::memory_order_relaxed);
+        });
+        job.writer.close();
+    }
+    background.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - background.start).count();
+    background.running.store(false, std::memory_order_release);
+}
+
+void cancelCalculations() {
+    background.cancel.store(true, std::memory_order_relaxed);
+    if (background.worker.joinable()) background.worker.join();
+}
+
+// textures of the heatmaps on screen, reset with every run
+static HeatmapCache heatmaps;
+static ImPlotColormap heatmap_colormap = ImPlotColormap_Viridis;
+
+void prepareCalculations() {
+    cancelCalculations();
+    heatmaps.clear();
+    SimulationConfig config = gui_simulation_config();
+    background.job_count = 0;
+    background.total = 0;
+    background.error.clear();
+    // the other diffusion method from the same initial board, shown next to the baseline
+    steps_explicit.close();
+    steps_adi.close();
+    // baseline run according to current method
+    if (!start_job(config, steps, "run")) return;
+
+    if (compare_methods) {
+        // IMEX always diffuses implicitly, the comparison run splits with Strang instead
+        if (config.integrator == INTEGRATOR_IMEX) {
+            config.integrator = INTEGRATOR_STRANG;
+            config.adaptive = false;
+        }
+        if (config.method == DIFFUSION_ADI) {
+            config.method = DIFFUSION_EXPLICIT;
+            if (!start_job(config, steps_explicit, "explicit")) return discard_jobs();
+        } else {
+            config.method = DIFFUSION_ADI;
+            if (!start_job(config, steps_adi, "adi")) return discard_jobs();
+        }
+    }
+
+    background.total = background.job_count * config.steps;
+    background.completed.store(0, std::memory_order_relaxed);
+    background.cancel.store(false, std::memory_order_relaxed);
+    background.failed.store(false, std::memory_order_relaxed);
+    background.running.store(true, std::memory_order_relaxed);
+    profile_reset();
+    background.start = std::chrono::steady_clock::now();
+    selected_timestep = 1;
+    background.worker = std::thread(run_jobs);
+}
+
+// maps the frames the worker published since the last call
+static void follow_published() {
+    for (int j = 0; j < background.job_count; ++j) {
+        SimulationJob& job = background.jobs[j];
+        if (job.published.load(std::memory_order_acquire) > job.frames->size()) job.frames->refresh();
+    }
+}
+
+void releaseHeatmapTextures() {
+    heatmaps.clear();
+}
+
+// at most this many tick labels per axis, larger boards label every n-th cell
+#define HEATMAP_MAX_TICKS 20
+
+// "C1".."Cn" / "R1".."Rn" tick labels at the cell centers, rebuilt only when the board size changes
+struct AxisTicks {
+    int count = -1;
+    vector<std::string> text;
+    vector<const char*> labels;
+    vector<double> positions;
+};
+
+static void update_ticks(AxisTicks& ticks, int count, const char* prefix, bool top_down) {
+    if (ticks.count == count) return;
+    ticks.count = count;
+    ticks.text.clear();
+    ticks.positions.clear();
+    const int every = (count + HEATMAP_MAX_TICKS - 1) / HEATMAP_MAX_TICKS;
+    for (int i = 0; i < count; i += every) {
+        ticks.text.push_back(std::string(prefix) + std::to_string(i + 1));
+        const double center = (i + 0.5) / count;
+        ticks.positions.push_back(top_down ? 1.0 - center : center);
+    }
+    ticks.labels.clear();
+    for (const auto& t : ticks.text) ticks.labels.push_back(t.c_str());
 }
 
 static bool auto_scale = true;
@@ -29,16 +220,45 @@ void simulations_render_header() {
     double size_x = std::max(40.0f, avail_w / 3.0f);
 
     ImGui::SetNextItemWidth(size_x-90);
-    static ImPlotColormap map = ImPlotColormap_Viridis;
-    if (ImPlot::ColormapButton(ImPlot::GetColormapName(map),ImVec2(size_x-90,0),map)) {
-        map = (map + 1) % ImPlot::GetColormapCount();
-        ImPlot::BustColorCache("##Heatmap1");
+    if (ImPlot::ColormapButton(ImPlot::GetColormapName(heatmap_colormap),ImVec2(size_x-90,0),heatmap_colormap)) {
+        heatmap_colormap = (heatmap_colormap + 1) % ImPlot::GetColormapCount();
     }
     ImGui::SameLine();
     ImGui::SetNextItemWidth(size_x-150);
     ImGui::LabelText("##Colormap Index", "%s", "Change Heatmap");
-    ImGui::SliderInt("Timestep", &selected_timestep, 1, number_steps_t, "%d", ImGuiSliderFlags_NoInput);
+    follow_published();
+    const bool running = background.running.load(std::memory_order_acquire);
+    const int done = background.completed.load(std::memory_order_relaxed);
+    const double elapsed = running ? std::chrono::duration<double>(std::chrono::steady_clock::now() - background.start).count() : background.seconds;
+    char progress[96];
+    snprintf(progress, sizeof(progress), "%d / %d steps, %.0f steps/s%s", done, background.total, elapsed > 0.0 ? done / elapsed : 0.0,
+             running ? "" : (done < background.total ? " (stopped)" : " (done)"));
+    if (!background.error.empty()) ImGui::TextColored(ImVec4(1,0.3f,0.3f,1), "%s", background.error.c_str());
+    else ImGui::ProgressBar(background.total > 0 ? (float)done / background.total : 1.0f, ImVec2(-1, 0), progress);
+    if (background.failed.load(std::memory_order_relaxed)) ImGui::TextColored(ImVec4(1,0.6f,0,1), "Writing the trajectory failed, the run was stopped");
+    // per-phase breakdown of the finished run
+    if (profile_enabled && !running && background.total > 0 && ImGui::TreeNode("Solver phases")) {
+        const ProfileTotals totals = profile_snapshot();
+        for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+            if (totals.calls[p] == 0) continue;
+            const double ms = totals.nanoseconds[p] / 1e6;
+            ImGui::Text("%-20s %10.1f ms %5.1f%%  %.3f ms/call", profile_phase_name(static_cast<ProfilePhase>(p)), ms,
+                        100.0 * ms / (background.seconds * 1e3), ms / totals.calls[p]);
+        }
+        ImGui::TreePop();
+    }
+
+    // the slider walks the recorded frames and shows their timestep
+    static bool follow_latest = true;
+    const int frames = std::max(1, (int)steps.size());
+    if (running && follow_latest) selected_timestep = frames;
+    selected_timestep = std::clamp(selected_timestep, 1, frames);
+    char step_label[32] = "-";
+    if (!steps.empty()) snprintf(step_label, sizeof(step_label), "step %d", steps.step(selected_timestep - 1));
+    // scrubbing back in time stops following the run
+    if (ImGui::SliderInt("Timestep", &selected_timestep, 1, frames, step_label, ImGuiSliderFlags_NoInput) && selected_timestep < frames) follow_latest = false;
     ImGui::Checkbox("Auto scale heatmaps", &auto_scale);
+    if (running) { ImGui::SameLine(); ImGui::Checkbox("Follow latest frame", &follow_latest); }
     if (compare_methods) ImGui::Text("Left: Current method   Right: Other method");
 }
 
@@ -54,31 +274,42 @@ void simulations_render_grids() {
     ImGuiStyle& style = ImGui::GetStyle();
     ImVec2 originalCellPadding = style.CellPadding;     // Save original cell padding
     style.CellPadding = ImVec2(10, 10);
-    static ImPlotHeatmapFlags hm_flags = 0; static ImPlotColormap map = ImPlotColormap_Viridis;
+    const ImPlotColormap map = heatmap_colormap;
+    static AxisTicks xticks, yticks;
     if (ImGui::BeginTable("Grid Table", cols, ImGuiTableFlags_SizingFixedFit )) {
-        auto draw_one = [&](int species_index, const std::vector<std::vector<std::vector<std::vector<double>>>>& src_steps, const char* tag){
-            int nrows = board_height, ncols = board_width;
-            static std::vector<double> flat; flat.resize(nrows*ncols);
-            for (int y=0;y<nrows;++y) for (int x=0;x<ncols;++x) flat[y*ncols+x]=src_steps[selected_timestep-1][species_index][y][x];
-            // labels
-            vector<std::string> xlabels_str; vector<const char*> xlabels_cstr;
-            vector<std::string> ylabels_str; vector<const char*> ylabels_cstr;
-            generate_labels(xlabels_str, board_width, "C"); generate_labels(ylabels_str, board_height, "R");
-            xlabels_cstr.reserve(xlabels_str.size()); for (const auto& s:xlabels_str) xlabels_cstr.push_back(s.c_str());
-            ylabels_cstr.reserve(ylabels_str.size()); for (const auto& s:ylabels_str) ylabels_cstr.push_back(s.c_str());
+        auto draw_one = [&](int species_index, TrajectoryReader& src_steps, const char* tag){
+            // the comparison runs start once the baseline run is done: until they reach the selected
+            // frame, hold its place rather than showing another step or another run
+            if (src_steps.size() < static_cast<size_t>(selected_timestep)) {
+                ImGui::PushID(tag); ImGui::PushID(species_index);
+                ImGui::TextDisabled("Waiting for frame %d...", selected_timestep);
+                ImGui::Dummy(ImVec2(static_cast<float>(size_x) + colorbar_w, static_cast<float>(size_x)));
+                ImGui::PopID(); ImGui::PopID();
+                return;
+            }
+            const size_t frame = selected_timestep - 1;
+            const int height = src_steps.height(), width = src_steps.width();
+            update_ticks(xticks, width, "C", false);
+            update_ticks(yticks, height, "R", true);
             static ImPlotAxisFlags axes_flags = ImPlotAxisFlags_Lock | ImPlotAxisFlags_NoGridLines | ImPlotAxisFlags_NoTickMarks;
-            // autoscale
-            static double scale_min = 0.0; double scale_max = 100.0;
-            if (auto_scale) { double mx=0.0; for (double v: flat) mx = std::max(mx, v); scale_max = std::max(1.0, mx); }
-            std::string tag_str = std::string(tag);
-            if (ImPlot::BeginPlot((std::string("##Heatmap")+tag_str+std::to_string(species_index)).c_str(), ImVec2(size_x,size_x), ImPlotFlags_NoLegend|ImPlotFlags_NoMouseText)){
+            // autoscale from the statistics recorded with the frame
+            double scale_min = 0.0, scale_max = 100.0;
+            if (auto_scale) scale_max = std::max(1.0, src_steps.stats(frame)[species_index].max);
+            // frames never change once recorded, only a new frame, colormap or range needs an upload
+            const HeatmapKey key{&src_steps, frame, species_index, map, scale_min, scale_max};
+            unsigned int texture = heatmaps.find(key);
+            if (!texture) texture = heatmaps.upload(key, src_steps[frame].plane(species_index), height, width);
+            ImGui::PushID(tag); ImGui::PushID(species_index);
+            if (ImPlot::BeginPlot("##Heatmap", ImVec2(size_x,size_x), ImPlotFlags_NoLegend|ImPlotFlags_NoMouseText)){
                 ImPlot::SetupAxes(nullptr, nullptr, axes_flags, axes_flags);
-                ImPlot::SetupAxisTicks(ImAxis_X1, 0 + 1.0/(2*board_width), 1 - 1.0/(2*board_width), board_width, xlabels_cstr.data());
-                ImPlot::SetupAxisTicks(ImAxis_Y1, 1 - 1.0/(2*board_height), 0 + 1.0/(2*board_height), board_height, ylabels_cstr.data());
-                ImPlot::PlotHeatmap((std::string("heat")+tag_str+std::to_string(species_index)).c_str(), flat.data(), board_height, board_width, scale_min, scale_max, nullptr, ImPlotPoint(0,0), ImPlotPoint(1,1), hm_flags);
+                ImPlot::SetupAxisTicks(ImAxis_X1, xticks.positions.data(), (int)xticks.positions.size(), xticks.labels.data());
+                ImPlot::SetupAxisTicks(ImAxis_Y1, yticks.positions.data(), (int)yticks.positions.size(), yticks.labels.data());
+                // texture row 0 is drawn at the top, like the heatmap rows
+                ImPlot::PlotImage("heat", (ImTextureID)(intptr_t)texture, ImPlotPoint(0,0), ImPlotPoint(1,1));
                 ImPlot::EndPlot();
             }
-            ImGui::SameLine(); ImPlot::ColormapScale((std::string("##HeatScale")+tag_str+std::to_string(species_index)).c_str(), scale_min, scale_max, ImVec2(50,size_x));
+            ImGui::SameLine(); ImPlot::ColormapScale("##HeatScale", scale_min, scale_max, ImVec2(50,size_x));
+            ImGui::PopID(); ImGui::PopID();
         };
 
         if (!compare_methods) {
@@ -88,7 +319,8 @@ void simulations_render_grids() {
                 if (i<species.size()) { ImGui::TableSetColumnIndex(1); ImPlot::PushColormap(map); draw_one(i, steps, "B"); ImPlot::PopColormap(); ++i; }
             }
         } else {
-            const auto& ref_steps = (diffusion_method == DIFFUSION_ADI && steps_explicit.size()) ? steps_explicit : (steps_adi.size() ? steps_adi : steps);
+            // every run records the same steps, so frame indices line up between the panels
+            auto& ref_steps = (diffusion_method == DIFFUSION_ADI) ? steps_explicit : steps_adi;
             for (int i=0; i<species.size(); ++i) {
                 ImGui::TableNextRow();
                 ImGui::TableSetColumnIndex(0); ImPlot::PushColormap(map); draw_one(i, steps, "L"); ImPlot::PopColormap();
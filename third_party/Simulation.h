@@ -1,6 +1,17 @@
-#ifndef SIMULATION
-#define SIMULATION
+#ifndef SIMULATION_H
+#define SIMULATION_H
+#include "./SimConfig.h"
+
+// snapshot of the configuration screen as a solver config
+SimulationConfig gui_simulation_config();
+// starts the configured simulation (and the comparison runs) on a background thread,
+// steps, steps_explicit and steps_adi fill up while it runs
+void prepareCalculations();
+// stops a running simulation and waits for its thread, the frames recorded so far stay readable
+void cancelCalculations();
 void simulations_render_header();
 void simulations_render_grids();
+// deletes the cached heatmap textures, called before the GL context goes away
+void releaseHeatmapTextures();
 
 #endif
@@ -1,9 +1,28 @@
 #ifndef SPECIES_H
 #define SPECIES_H
+#include <cstdint>
 #include <string>
 #include <iostream>
 using namespace std;
 
+// display palette, one color per species slot
+inline uint32_t colors[15] = {
+    0xFF0000FF, // Red
+    0x00FF00FF, // Green
+    0xFFFF00FF, // Yellow
+    0x32CD32FF, // Lime Green
+    0xADD8E6FF, // Light Blue
+    0xFF00FFFF, // Cyan
+    0x808080FF, // Gray
+    0xFFA500FF, // Orange
+    0x800080FF, // Purple
+    0x008080FF, // Teal
+    0xFF69B4FF, // Pink
+    0xFFFFFFFF, // White
+    0x8B0000FF, // Dark Red
+    0x2E8B57FF, // Sea Green
+    0x4682B4FF  // Steel Blue
+};
 
 class Species {
     // are there many per block or one
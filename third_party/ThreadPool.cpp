@@ -0,0 +1,75 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+int ThreadPool::resolve_threads(int threads) {
+    if (threads > 0) return std::min(threads, max_threads());
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+int ThreadPool::max_threads() {
+    return 4 * static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+ThreadPool::ThreadPool(int threads) {
+    const int n = resolve_threads(threads);
+    for (int worker = 1; worker < n; worker++) {
+        workers_.emplace_back(&ThreadPool::worker_loop, this, worker);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+void ThreadPool::run_chunk(int worker) {
+    const long n = end_ - begin_;
+    const int chunk_begin = begin_ + static_cast<int>(n * worker / size());
+    const int chunk_end = begin_ + static_cast<int>(n * (worker + 1) / size());
+    if (chunk_begin < chunk_end) call_(task_, chunk_begin, chunk_end, worker);
+}
+
+void ThreadPool::worker_loop(int worker) {
+    std::uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+        }
+        run_chunk(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) done_cv_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::run(int begin, int end, ChunkFn call, const void* fn) {
+    if (begin >= end) return;
+    // not worth waking the workers for a single item
+    if (workers_.empty() || end - begin == 1) {
+        call(fn, begin, end, 0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        call_ = call;
+        task_ = fn;
+        begin_ = begin;
+        end_ = end;
+        pending_ = static_cast<int>(workers_.size());
+        generation_++;
+    }
+    start_cv_.notify_all();
+    run_chunk(0);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [&] { return pending_ == 0; });
+    call_ = nullptr;
+    task_ = nullptr;
+}
@@ -0,0 +1,59 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of worker threads that stay alive between parallel_for calls
+// the calling thread always works as worker 0, so a pool of size 1 spawns no threads
+class ThreadPool {
+public:
+    // @param threads total number of workers including the caller, <= 0 uses every hardware thread
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return static_cast<int>(workers_.size()) + 1; }
+
+    // splits [begin, end) into size() contiguous chunks and runs fn(chunk_begin, chunk_end, worker) for every
+    // non-empty chunk, returns when all chunks are done
+    // the split only depends on the range and size(), never on timing
+    // fn is called through a plain function pointer, so no call allocates
+    template <typename Fn>
+    void parallel_for(int begin, int end, const Fn& fn) {
+        run(begin, end, [](const void* f, int chunk_begin, int chunk_end, int worker) {
+            (*static_cast<const Fn*>(f))(chunk_begin, chunk_end, worker);
+        }, &fn);
+    }
+
+    // number of workers a pool built with `threads` would have, at most max_threads()
+    static int resolve_threads(int threads);
+    // largest pool size, four workers per hardware thread; more only adds scheduling overhead
+    static int max_threads();
+
+private:
+    using ChunkFn = void (*)(const void* fn, int chunk_begin, int chunk_end, int worker);
+
+    void run(int begin, int end, ChunkFn call, const void* fn);
+    void worker_loop(int worker);
+    void run_chunk(int worker);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    ChunkFn call_ = nullptr;
+    const void* task_ = nullptr;
+    int begin_ = 0;
+    int end_ = 0;
+    int pending_ = 0;
+    std::uint64_t generation_ = 0;
+    bool stop_ = false;
+};
+
+#endif // THREAD_POOL_H
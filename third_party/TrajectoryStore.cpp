@@ -0,0 +1,437 @@
+#include "TrajectoryStore.h"
+#include <cerrno>
+#include <cstring>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define RECORD_KEYFRAME 1u
+
+// bytes per stored value
+static std::size_t word_bytes(const StoreHeader& header) {
+    return header.precision == 1 ? sizeof(float) : sizeof(double);
+}
+
+static std::size_t frame_values(const StoreHeader& header) {
+    return static_cast<std::size_t>(header.species) * header.height * header.width;
+}
+
+static std::size_t padded(std::size_t bytes) {
+    return (bytes + 7) / 8 * 8;
+}
+
+// bit pattern of `value` at the stored precision
+static uint64_t to_word(double value, bool single) {
+    if (single) {
+        float f = static_cast<float>(value);
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        return bits;
+    }
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double from_word(uint64_t word, bool single) {
+    if (single) {
+        uint32_t bits = static_cast<uint32_t>(word);
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+    double d;
+    std::memcpy(&d, &word, sizeof(d));
+    return d;
+}
+
+// packs current ^ previous: one nibble per value with its number of leading zero bytes,
+// followed by the remaining low bytes of every value, little-endian
+static void pack_delta(const std::vector<uint64_t>& current, const std::vector<uint64_t>& previous, std::size_t wb, std::vector<uint8_t>& out) {
+    const std::size_t n = current.size();
+    const std::size_t control = (n + 1) / 2;
+    out.assign(control, 0);
+    out.reserve(control + n * wb);
+    for (std::size_t i = 0; i < n; i++) {
+        uint64_t x = current[i] ^ previous[i];
+        std::size_t used = 0;
+        for (uint64_t v = x; v != 0; v >>= 8) used++;
+        out[i / 2] |= static_cast<uint8_t>((wb - used) << (4 * (i % 2)));
+        for (std::size_t b = 0; b < used; b++) out.push_back(static_cast<uint8_t>(x >> (8 * b)));
+    }
+}
+
+// inverse of pack_delta, applied in place to the previous frame in `words`
+// never reads past the `size` bytes of the payload, a damaged payload only yields wrong values
+static void unpack_delta(const uint8_t* in, std::size_t size, std::size_t wb, std::vector<uint64_t>& words) {
+    const std::size_t n = words.size();
+    if (size < (n + 1) / 2) return;
+    const uint8_t* bytes = in + (n + 1) / 2;
+    const uint8_t* end = in + size;
+    for (std::size_t i = 0; i < n; i++) {
+        const std::size_t skipped = (in[i / 2] >> (4 * (i % 2))) & 0xF;
+        const std::size_t used = skipped < wb ? wb - skipped : 0;
+        if (used > static_cast<std::size_t>(end - bytes)) return;
+        uint64_t x = 0;
+        for (std::size_t b = 0; b < used; b++) x |= static_cast<uint64_t>(bytes[b]) << (8 * b);
+        bytes += used;
+        words[i] ^= x;
+    }
+}
+
+bool TrajectoryWriter::open(const std::string& path, const SimulationConfig& config, const TrajectoryOptions& options, std::string& error) {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        error = "cannot write " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    options_ = options;
+    options_.stride = std::max(1, options.stride);
+    options_.keyframe_interval = std::max(1, options.keyframe_interval);
+
+    header_ = StoreHeader{};
+    std::memcpy(header_.magic, STORE_MAGIC, 4);
+    header_.version = STORE_VERSION;
+    header_.species = config.species();
+    header_.height = config.height;
+    header_.width = config.width;
+    header_.precision = options_.float32 ? 1 : 0;
+    header_.encoding = options_.delta ? 1 : 0;
+    header_.keyframe_interval = options_.keyframe_interval;
+    header_.stride = options_.stride;
+    header_.delta_time = config.delta_time;
+    last_step_ = config.steps;
+    frames_ = 0;
+
+    const std::size_t n = frame_values(header_);
+    previous_.assign(options_.delta ? n : 0, 0);
+    current_.assign(options_.delta ? n : 0, 0);
+    payload_.clear();
+    payload_.reserve(padded(n * word_bytes(header_)));
+    stats_.assign(header_.species, FrameStats{});
+
+    bytes_ = sizeof(header_);
+    if (std::fwrite(&header_, sizeof(header_), 1, file_) != 1 || std::fflush(file_) != 0) {
+        error = "cannot write " + path;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool TrajectoryWriter::write(int step, const Field& state) {
+    if (!file_) return false;
+    if (step % options_.stride != 0 && step != last_step_) return true;
+
+    const bool single = options_.float32;
+    const std::size_t wb = word_bytes(header_);
+    const std::size_t plane = state.plane_size();
+    for (int k = 0; k < header_.species; k++) {
+        const double* src = state.plane(k);
+        FrameStats st{src[0], src[0], 0.0};
+        for (std::size_t i = 0; i < plane; i++) {
+            st.min = std::min(st.min, src[i]);
+            st.max = std::max(st.max, src[i]);
+            st.sum += src[i];
+        }
+        stats_[k] = st;
+    }
+    bool keyframe = !options_.delta || frames_ % options_.keyframe_interval == 0;
+    if (options_.delta) {
+        for (int k = 0; k < header_.species; k++) {
+            const double* src = state.plane(k);
+            uint64_t* dst = current_.data() + k * plane;
+            for (std::size_t i = 0; i < plane; i++) dst[i] = to_word(src[i], single);
+        }
+        if (!keyframe) {
+            pack_delta(current_, previous_, wb, payload_);
+            // frames that do not compress are stored raw, so a delta payload is never longer than a keyframe
+            keyframe = payload_.size() > plane * header_.species * wb;
+        }
+        previous_.swap(current_);
+    }
+    if (keyframe) {
+        // planes without their alignment padding
+        payload_.resize(plane * header_.species * wb);
+        for (int k = 0; k < header_.species; k++) {
+            const double* src = state.plane(k);
+            uint8_t* dst = payload_.data() + k * plane * wb;
+            if (!single) {
+                std::memcpy(dst, src, plane * sizeof(double));
+            } else {
+                for (std::size_t i = 0; i < plane; i++) {
+                    const float f = static_cast<float>(src[i]);
+                    std::memcpy(dst + i * sizeof(float), &f, sizeof(float));
+                }
+            }
+        }
+    }
+    payload_.resize(padded(payload_.size()), 0);
+
+    RecordHeader record{step, keyframe ? RECORD_KEYFRAME : 0u, payload_.size()};
+    if (std::fwrite(&record, sizeof(record), 1, file_) != 1) return false;
+    if (std::fwrite(stats_.data(), sizeof(FrameStats), stats_.size(), file_) != stats_.size()) return false;
+    if (!payload_.empty() && std::fwrite(payload_.data(), 1, payload_.size(), file_) != payload_.size()) return false;
+    // complete records become visible to readers following the file
+    if (std::fflush(file_) != 0) return false;
+    bytes_ += sizeof(record) + stats_.size() * sizeof(FrameStats) + payload_.size();
+    frames_++;
+    return true;
+}
+
+bool TrajectoryWriter::close() {
+    if (!file_) return true;
+    const bool ok = std::fclose(file_) == 0;
+    file_ = nullptr;
+    return ok;
+}
+
+// read-only file access of the reader: a file descriptor on POSIX, a HANDLE on Windows,
+// NO_FILE (-1, also INVALID_HANDLE_VALUE) when closed
+#ifdef _WIN32
+
+static intptr_t open_read_only(const std::string& path) {
+    // the writer keeps appending and the GUI deletes its temporary files while they are read
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    return reinterpret_cast<intptr_t>(file);
+}
+
+static std::string open_error() {
+    return "error " + std::to_string(GetLastError());
+}
+
+static void close_file(intptr_t file) {
+    CloseHandle(reinterpret_cast<HANDLE>(file));
+}
+
+static bool file_size(intptr_t file, std::size_t& size) {
+    LARGE_INTEGER li;
+    if (!GetFileSizeEx(reinterpret_cast<HANDLE>(file), &li)) return false;
+    size = static_cast<std::size_t>(li.QuadPart);
+    return true;
+}
+
+static bool read_at(intptr_t file, void* dst, std::size_t bytes, uint64_t offset) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    while (bytes > 0) {
+        OVERLAPPED at{};
+        at.Offset = static_cast<DWORD>(offset);
+        at.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        const DWORD chunk = static_cast<DWORD>(std::min<std::size_t>(bytes, 1u << 30));
+        DWORD read = 0;
+        if (!ReadFile(reinterpret_cast<HANDLE>(file), out, chunk, &read, &at) || read == 0) return false;
+        out += read;
+        offset += read;
+        bytes -= read;
+    }
+    return true;
+}
+
+// @return nullptr if the file cannot be mapped
+static const uint8_t* map_file(intptr_t file, std::size_t size) {
+    const uint64_t size64 = size;
+    HANDLE mapping = CreateFileMappingA(reinterpret_cast<HANDLE>(file), nullptr, PAGE_READONLY,
+                                       static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64), nullptr);
+    if (!mapping) return nullptr;
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    // the view keeps the mapping object alive
+    CloseHandle(mapping);
+    return static_cast<const uint8_t*>(view);
+}
+
+static void unmap_file(const uint8_t* data, std::size_t) {
+    UnmapViewOfFile(data);
+}
+
+#else
+
+static intptr_t open_read_only(const std::string& path) {
+    return ::open(path.c_str(), O_RDONLY);
+}
+
+static std::string open_error() {
+    return std::strerror(errno);
+}
+
+static void close_file(intptr_t file) {
+    ::close(static_cast<int>(file));
+}
+
+static bool file_size(intptr_t file, std::size_t& size) {
+    struct stat st {};
+    if (fstat(static_cast<int>(file), &st) != 0) return false;
+    size = static_cast<std::size_t>(st.st_size);
+    return true;
+}
+
+static bool read_at(intptr_t file, void* dst, std::size_t bytes, uint64_t offset) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    while (bytes > 0) {
+        const ssize_t read = ::pread(static_cast<int>(file), out, bytes, static_cast<off_t>(offset));
+        if (read <= 0) return false;
+        out += read;
+        offset += read;
+        bytes -= read;
+    }
+    return true;
+}
+
+// @return nullptr if the file cannot be mapped
+static const uint8_t* map_file(intptr_t file, std::size_t size) {
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, static_cast<int>(file), 0);
+    return mapped == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(mapped);
+}
+
+static void unmap_file(const uint8_t* data, std::size_t size) {
+    munmap(const_cast<uint8_t*>(data), size);
+}
+
+#endif // _WIN32
+
+bool TrajectoryReader::open(const std::string& path, std::string& error, bool temporary) {
+    close();
+    file_ = open_read_only(path);
+    if (file_ == NO_FILE) {
+        error = "cannot open " + path + ": " + open_error();
+        return false;
+    }
+    if (temporary) temporary_ = path;
+    std::size_t size = 0;
+    if (!file_size(file_, size) || size < sizeof(StoreHeader) || !read_at(file_, &header_, sizeof(header_), 0)
+        || std::memcmp(header_.magic, STORE_MAGIC, 4) != 0 || header_.version != STORE_VERSION) {
+        error = path + " is not a SimDynamiX trajectory";
+        close();
+        return false;
+    }
+    if (header_.species < 1 || header_.height < 1 || header_.width < 1 || header_.precision > 1 || header_.encoding > 1) {
+        error = path + " has an invalid header";
+        close();
+        return false;
+    }
+    values_.assign(frame_values(header_), 0.0);
+    words_.assign(frame_values(header_), 0);
+    refresh();
+    if (corrupt_) {
+        error = path + " has a damaged record after frame " + std::to_string(index_.size());
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TrajectoryReader::close() {
+    if (map_ && mapped_) unmap_file(map_, map_size_);
+    if (file_ != NO_FILE) close_file(file_);
+    file_ = NO_FILE;
+    // after the handle is closed, Windows does not delete open files
+    if (!temporary_.empty()) std::remove(temporary_.c_str());
+    temporary_.clear();
+    map_ = nullptr;
+    map_size_ = 0;
+    mapped_ = false;
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    scanned_ = sizeof(StoreHeader);
+    header_ = StoreHeader{};
+    index_.clear();
+    decoded_ = -1;
+    corrupt_ = false;
+}
+
+// maps the first `size` bytes of the file, pages are only read once they are touched
+// where the file cannot be mapped it is read into memory instead, appending to what was read before
+bool TrajectoryReader::map(std::size_t size) {
+    if (size == map_size_) return true;
+    if (const uint8_t* mapped = map_file(file_, size)) {
+        if (map_ && mapped_) unmap_file(map_, map_size_);
+        map_ = mapped;
+        map_size_ = size;
+        mapped_ = true;
+        return true;
+    }
+    const std::size_t have = mapped_ ? 0 : map_size_;
+    buffer_.resize(size);
+    if (!read_at(file_, buffer_.data() + have, size - have, have)) {
+        buffer_.resize(have);
+        return false;
+    }
+    if (map_ && mapped_) unmap_file(map_, map_size_);
+    map_ = buffer_.data();
+    map_size_ = size;
+    mapped_ = false;
+    return true;
+}
+
+std::size_t TrajectoryReader::refresh() {
+    if (file_ == NO_FILE || corrupt_) return index_.size();
+    std::size_t size = 0;
+    if (!file_size(file_, size)) return index_.size();
+    if (size <= scanned_ || !map(size)) return index_.size();
+
+    const std::size_t raw_bytes = padded(frame_values(header_) * word_bytes(header_));
+    while (scanned_ + sizeof(RecordHeader) <= map_size_) {
+        RecordHeader record;
+        std::memcpy(&record, map_ + scanned_, sizeof(record));
+        const uint64_t offset = scanned_ + sizeof(record) + header_.species * sizeof(FrameStats);
+        const bool keyframe = record.flags & RECORD_KEYFRAME;
+        // keyframes are exactly one raw frame, delta frames never longer; the first frame has no
+        // predecessor to apply a delta to. Anything else is not a record this writer produced
+        if (keyframe ? record.bytes != raw_bytes : (index_.empty() || record.bytes > raw_bytes)) {
+            corrupt_ = true;
+            break;
+        }
+        // a record still being written
+        if (offset > map_size_ || record.bytes > map_size_ - offset) break;
+        index_.push_back({offset, record.bytes, record.step, keyframe});
+        scanned_ = offset + record.bytes;
+    }
+    return index_.size();
+}
+
+// decodes frame t into words_, continuing from the last decoded frame when possible
+void TrajectoryReader::decode(std::size_t t) {
+    const std::size_t wb = word_bytes(header_);
+    std::size_t start = t;
+    while (start > 0 && !index_[start].keyframe) start--;
+    if (decoded_ >= static_cast<long>(start) && decoded_ < static_cast<long>(t)) start = decoded_ + 1;
+
+    for (std::size_t f = start; f <= t; f++) {
+        const uint8_t* payload = map_ + index_[f].offset;
+        if (index_[f].keyframe) {
+            for (std::size_t i = 0; i < words_.size(); i++) {
+                uint64_t w = 0;
+                std::memcpy(&w, payload + i * wb, wb);
+                words_[i] = w;
+            }
+        } else {
+            unpack_delta(payload, index_[f].bytes, wb, words_);
+        }
+    }
+    decoded_ = static_cast<long>(t);
+}
+
+FieldView TrajectoryReader::operator[](std::size_t t) {
+    const std::size_t plane = static_cast<std::size_t>(header_.height) * header_.width;
+    FieldView view{nullptr, header_.species, header_.height, header_.width, plane};
+    // raw double frames are read straight from the mapping
+    if (header_.precision == 0 && index_[t].keyframe) {
+        view.data = reinterpret_cast<const double*>(map_ + index_[t].offset);
+        return view;
+    }
+    if (decoded_ != static_cast<long>(t)) {
+        decode(t);
+        const bool single = header_.precision == 1;
+        for (std::size_t i = 0; i < words_.size(); i++) values_[i] = from_word(words_[i], single);
+    }
+    view.data = values_.data();
+    return view;
+}
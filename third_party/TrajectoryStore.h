@@ -0,0 +1,153 @@
+#ifndef TRAJECTORY_STORE_H
+#define TRAJECTORY_STORE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "./Field.h"
+#include "./SimConfig.h"
+
+// On-disk trajectory ("SDX2"): a 64 byte StoreHeader followed by one record per recorded step.
+// Every record is a 16 byte RecordHeader, one FrameStats per species and a payload padded to 8 bytes:
+//  - raw frames hold the species planes as row-major float64 or float32 grids
+//  - delta frames hold the XOR of every value with the previous recorded frame, packed by dropping
+//    leading zero bytes (one control nibble per value, then the remaining low bytes)
+// Frames are lossless at the stored precision; every keyframe_interval-th frame is raw for random access.
+// All values are in host byte order (little-endian on every supported platform).
+
+#define STORE_MAGIC "SDX2"
+#define STORE_VERSION 3
+
+struct StoreHeader {
+    char magic[4];
+    uint32_t version;
+    int32_t species;
+    int32_t height;
+    int32_t width;
+    uint32_t precision;         // 0 float64, 1 float32
+    uint32_t encoding;          // 0 raw, 1 delta
+    uint32_t keyframe_interval; // frames between raw frames when delta encoded
+    int32_t stride;             // steps between recorded frames
+    uint32_t reserved;
+    double delta_time;
+    uint8_t padding[16];
+};
+static_assert(sizeof(StoreHeader) == 64, "StoreHeader must stay 64 bytes");
+
+struct RecordHeader {
+    int32_t step;
+    uint32_t flags;             // bit 0: raw keyframe
+    uint64_t bytes;             // padded payload size
+};
+static_assert(sizeof(RecordHeader) == 16, "RecordHeader must stay 16 bytes");
+
+// population range of one species in a recorded frame, computed once when the frame is written
+struct FrameStats {
+    double min;
+    double max;
+    double sum;
+};
+
+// how a run is recorded
+struct TrajectoryOptions {
+    int stride = 1;              // record every stride-th step, the first and last step are always recorded
+    bool float32 = false;        // store values as float32
+    bool delta = false;          // XOR-delta encode frames against the previous one
+    int keyframe_interval = 16;  // raw frame every n recorded frames when delta encoding
+};
+
+// streams the states of a run into a trajectory file
+class TrajectoryWriter {
+public:
+    TrajectoryWriter() = default;
+    ~TrajectoryWriter() { close(); }
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+    // creates `path` for a run of `config`, the header is on disk when open returns
+    // @return false with a message in `error` if the file cannot be written
+    bool open(const std::string& path, const SimulationConfig& config, const TrajectoryOptions& options, std::string& error);
+    // records `state` if `step` falls on the stride, every record is flushed so readers can follow the file
+    // @return false if writing failed
+    bool write(int step, const Field& state);
+    bool close();
+
+    bool is_open() const { return file_ != nullptr; }
+    std::size_t frames() const { return frames_; }
+    uint64_t bytes_written() const { return bytes_; }
+
+private:
+    FILE* file_ = nullptr;
+    StoreHeader header_{};
+    TrajectoryOptions options_;
+    int last_step_ = 0;
+    std::size_t frames_ = 0;
+    uint64_t bytes_ = 0;
+    std::vector<uint64_t> previous_;  // previous frame as stored words
+    std::vector<uint64_t> current_;
+    std::vector<uint8_t> payload_;
+    std::vector<FrameStats> stats_;
+};
+
+// random access to a trajectory file through a read-only memory mapping (mmap, or MapViewOfFile on Windows)
+// only the pages of the frames that are actually read get loaded; files that cannot be mapped are read instead
+class TrajectoryReader {
+public:
+    TrajectoryReader() = default;
+    ~TrajectoryReader() { close(); }
+    TrajectoryReader(const TrajectoryReader&) = delete;
+    TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+    // @param temporary deletes the file when the reader is closed
+    // @return false with a message in `error` if `path` is not a trajectory file or holds a damaged record
+    bool open(const std::string& path, std::string& error, bool temporary = false);
+    void close();
+
+    // maps data appended since the last call (for files still being written) and indexes complete frames
+    // indexing stops for good at the first damaged record
+    // @return number of indexed frames
+    std::size_t refresh();
+
+    std::size_t size() const { return index_.size(); }
+    bool empty() const { return index_.empty(); }
+    int species() const { return header_.species; }
+    int height() const { return header_.height; }
+    int width() const { return header_.width; }
+    double delta_time() const { return header_.delta_time; }
+    const StoreHeader& header() const { return header_; }
+    // simulation step of frame t
+    int step(std::size_t t) const { return index_[t].step; }
+    // species() statistics of frame t, read from the mapping without decoding the frame
+    const FrameStats* stats(std::size_t t) const { return reinterpret_cast<const FrameStats*>(map_ + index_[t].offset) - header_.species; }
+
+    // frame t with plane stride height * width, valid until the next operator[], refresh() or close()
+    FieldView operator[](std::size_t t);
+
+private:
+    struct Entry {
+        uint64_t offset;  // payload offset
+        uint64_t bytes;
+        int32_t step;
+        bool keyframe;
+    };
+    bool map(std::size_t size);
+    void decode(std::size_t t);
+
+    static constexpr intptr_t NO_FILE = -1;
+    intptr_t file_ = NO_FILE;       // file descriptor, or HANDLE on Windows
+    const uint8_t* map_ = nullptr;  // the mapping, or buffer_ when the file could not be mapped
+    std::size_t map_size_ = 0;
+    bool mapped_ = false;
+    std::vector<uint8_t> buffer_;
+    std::string temporary_;         // deleted on close
+    std::size_t scanned_ = sizeof(StoreHeader);
+    StoreHeader header_{};
+    std::vector<Entry> index_;
+    std::vector<uint64_t> words_;   // decoded frame as stored words, reference of the next delta frame
+    AlignedVector<double> values_;  // decoded frame
+    long decoded_ = -1;
+    bool corrupt_ = false;          // a record failed the size checks, nothing after it is indexed
+};
+
+#endif // TRAJECTORY_STORE_H
@@ -0,0 +1,82 @@
+#include "Tridiagonal.h"
+
+// (I - r T): internal nodes diag = 1 + 2r, off = -r
+static void build_tridiagonal_neumann(int n, double r, std::vector<double>& a, std::vector<double>& b, std::vector<double>& c) {
+    a.assign(n, 0.0);
+    b.assign(n, 0.0);
+    c.assign(n, 0.0);
+    // For (I - r T) with T having Neumann-modified ends: off-diagonal magnitude doubles at boundaries
+    // Internal nodes: diag = 1 + 2r, off = -r
+    for (int i = 0; i < n; ++i) {
+        b[i] = 1.0 + 2.0 * r;
+        if (i > 0) a[i] = -r;
+        if (i < n - 1) c[i] = -r;
+    }
+    // Neumann adjustment: first and last off-diagonal doubled in magnitude (because T boundary off-diag is 2)
+    if (n >= 2) {
+        c[0] = -2.0 * r;
+        a[n - 1] = -2.0 * r;
+    }
+}
+
+static void build_tridiagonal_dirichlet(int n, double r, std::vector<double>& a, std::vector<double>& b, std::vector<double>& c) {
+    a.assign(n, 0.0);
+    b.assign(n, 0.0);
+    c.assign(n, 0.0);
+    for (int i = 0; i < n; ++i) {
+        b[i] = 1.0 + 2.0 * r;
+        if (i > 0) a[i] = -r;
+        if (i < n - 1) c[i] = -r;
+    }
+    // Dirichlet BC: nothing special beyond standard tri-diagonal; boundaries remain as set
+}
+
+void factorize_tridiagonal(int n, double r, BoundaryCondition bc, TridiagonalFactorization& f) {
+    // the sub-diagonal is built into `multiplier` and replaced entry by entry during the elimination,
+    // so refactorizing an existing factorization of the same size allocates nothing
+    std::vector<double>& a = f.multiplier;
+    if (bc == BC_NEUMANN) build_tridiagonal_neumann(n, r, a, f.diagonal, f.super);
+    else build_tridiagonal_dirichlet(n, r, a, f.diagonal, f.super);
+    f.n = n;
+    // forward elimination of the matrix part of the Thomas algorithm
+    for (int i = 1; i < n; ++i) {
+        f.multiplier[i] = a[i] / f.diagonal[i - 1];
+        f.diagonal[i] -= f.multiplier[i] * f.super[i - 1];
+    }
+}
+
+void solve_tridiagonal_batch(const TridiagonalFactorization& f, double* d, int batch, std::ptrdiff_t stride) {
+    const int n = f.n;
+    if (n == 0) return;
+    // forward sweep on the right-hand sides
+    for (int i = 1; i < n; ++i) {
+        const double m = f.multiplier[i];
+        double* __restrict row = d + i * stride;
+        const double* __restrict prev = row - stride;
+        for (int j = 0; j < batch; ++j) row[j] -= m * prev[j];
+    }
+    // back substitution
+    {
+        const double b = f.diagonal[n - 1];
+        double* __restrict row = d + (n - 1) * stride;
+        for (int j = 0; j < batch; ++j) row[j] /= b;
+    }
+    for (int i = n - 2; i >= 0; --i) {
+        const double b = f.diagonal[i];
+        const double c = f.super[i];
+        double* __restrict row = d + i * stride;
+        const double* __restrict next = row + stride;
+        for (int j = 0; j < batch; ++j) row[j] = (row[j] - c * next[j]) / b;
+    }
+}
+
+std::shared_ptr<const TridiagonalFactorization> TridiagonalCache::get(int n, double r, BoundaryCondition bc) {
+    const auto key = std::make_tuple(n, r, static_cast<int>(bc));
+    auto it = entries_.find(key);
+    if (it != entries_.end()) return it->second;
+    if (entries_.size() >= capacity) entries_.clear();
+    auto f = std::make_shared<TridiagonalFactorization>();
+    factorize_tridiagonal(n, r, bc, *f);
+    entries_.emplace(key, f);
+    return f;
+}
@@ -0,0 +1,41 @@
+#ifndef TRIDIAGONAL_H
+#define TRIDIAGONAL_H
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+#include "./SimConfig.h"
+
+// Thomas factorization of the Crank–Nicolson system (I - r T) of size n
+// the elimination only depends on the matrix, so it is done once and reused for every right-hand side
+struct TridiagonalFactorization {
+    int n = 0;
+    std::vector<double> multiplier; // m[i] = a[i] / b'[i-1], m[0] unused
+    std::vector<double> diagonal;   // eliminated diagonal b'
+    std::vector<double> super;      // super-diagonal c, c[n-1] unused
+};
+
+// factorizes (I - r T) with T the 1D second difference under the given boundary condition
+// `f` is overwritten, its buffers are reused when it already holds a system of size n
+void factorize_tridiagonal(int n, double r, BoundaryCondition bc, TridiagonalFactorization& f);
+
+// solves `batch` systems at once, interleaved: value i of system j lives at d[i * stride + j]
+// the systems are overwritten by their solutions, the inner loop runs over j and vectorizes
+void solve_tridiagonal_batch(const TridiagonalFactorization& f, double* d, int batch, std::ptrdiff_t stride);
+
+// factorizations by (size, r, boundary condition)
+// entries are shared, so evicting the cache never invalidates a factorization still in use
+class TridiagonalCache {
+public:
+    std::shared_ptr<const TridiagonalFactorization> get(int n, double r, BoundaryCondition bc);
+    std::size_t size() const { return entries_.size(); }
+
+private:
+    // enough for every species in both directions of a few different time steps
+    static constexpr std::size_t capacity = 128;
+    std::map<std::tuple<int, double, int>, std::shared_ptr<const TridiagonalFactorization>> entries_;
+};
+
+#endif // TRIDIAGONAL_H
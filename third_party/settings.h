@@ -5,6 +5,9 @@
 #include <GLFW/glfw3.h>
 #include <vector>
 #include "./Species.h"
+#include "./Field.h"
+#include "./TrajectoryStore.h"
+#include "./SimConfig.h"
 
 #define CANVAS_WIDTH 1320
 #define CANVAS_HEIGHT  820
@@ -21,42 +24,11 @@
 
 using namespace std;
 
-inline uint32_t colors[15] = {
-    0xFF0000FF, // Red
-    0x00FF00FF, // Green
-    0xFFFF00FF, // Yellow
-    0x32CD32FF, // Lime Green
-    0xADD8E6FF, // Light Blue
-    0xFF00FFFF, // Cyan
-    0x808080FF, // Gray
-    0xFFA500FF, // Orange
-    0x800080FF, // Purple
-    0x008080FF, // Teal
-    0xFF69B4FF, // Pink
-    0xFFFFFFFF, // White
-    0x8B0000FF, // Dark Red
-    0x2E8B57FF, // Sea Green
-    0x4682B4FF  // Steel Blue
-};
-
 enum State {
     CONFIGURATION,
     SIMULATION
 };
 
-// Diffusion method selection
-enum DiffusionMethod {
-    DIFFUSION_EXPLICIT = 0,
-    DIFFUSION_ADI = 1
-};
-
-// Boundary condition selection
-enum BoundaryCondition {
-    BC_DIRICHLET = 0, // value outside domain is 0
-    BC_NEUMANN = 1    // zero-flux, mirror at boundary
-};
-
-
 inline ImVec4 HexToImVec4(uint32_t hex) {
     float r = ((hex >> 24) & 0xFF) / 255.0f;
     float g = ((hex >> 16) & 0xFF) / 255.0f;
@@ -68,11 +40,15 @@ inline ImVec4 HexToImVec4(uint32_t hex) {
 inline State current = CONFIGURATION;
 inline DiffusionMethod diffusion_method = DIFFUSION_EXPLICIT;
 inline BoundaryCondition boundary_condition = BC_DIRICHLET;
-inline double delta_time = 1.0; // simulation time step
+inline double delta_time = 1.0; // simulation time step, the output interval with adaptive stepping
+inline Integrator integrator = INTEGRATOR_LIE;
+inline bool adaptive_steps = false; // error controlled internal steps, IMEX only
+inline double step_tolerance = 1e-4;
+inline int solver_threads = 0; // worker threads of the solver, 0 = every core
 inline int board_width = 10;
 inline int board_height = 10;
-// int because it represents for all 15 species its count of them in every block
-inline vector<vector<vector<double>>> board(board_height, vector<vector<double>>(board_width, vector<double>(15, 0.0)));
+// population of all 15 species slots in every block, species-major [species][y][x]
+inline Field board(15, board_height, board_width);
 inline vector<Species> species;
 inline vector<vector<double>> coefficients(15, vector<double>(15, 0.0));
 inline vector<double> dispersion_coefficients(15, 0.1);
@@ -80,10 +56,12 @@ inline vector<double> dispersion_coefficients(15, 0.1);
 inline int selected_box = -1; // not initalised
 inline int number_steps_t = 10;
 
-// 5 d, [step][population][y][x]
-inline vector<vector<vector<vector<double>>>> steps;
-inline vector<vector<vector<vector<double>>>> steps_explicit;
-inline vector<vector<vector<vector<double>>>> steps_adi;
+// recorded frames, steps[frame] is a [population][y][x] view of timestep steps.step(frame)
+// runs are streamed to disk and mapped back, only the frames on screen are paged in
+inline TrajectoryReader steps;
+inline TrajectoryReader steps_explicit;
+inline TrajectoryReader steps_adi;
+inline int snapshot_stride = 1; // record every n-th timestep
 
 inline bool compare_methods = false;
 